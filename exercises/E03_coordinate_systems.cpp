@@ -129,6 +129,7 @@ static void game_update(SDLContext* context, GameState* state)
 
 static void game_render(SDLContext* context, GameState* state)
 {
+	itu_lib_sprite_batch_begin(context);
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
@@ -137,11 +138,12 @@ static void game_render(SDLContext* context, GameState* state)
 		SDL_FRect rect_dst;
 
 		if(DEBUG_render_textures)
-			itu_lib_sprite_render(context, &entity->sprite, &entity->transform);
+			itu_lib_sprite_batch_add(context, &entity->sprite, &entity->transform);
 
 		if(DEBUG_render_outlines)
 			itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
 	}
+	itu_lib_sprite_batch_end(context);
 
 	// debug window
 	SDL_SetRenderDrawColor(context->renderer, 0xFF, 0x00, 0xFF, 0xff);
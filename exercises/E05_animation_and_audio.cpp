@@ -239,7 +239,7 @@ static void game_reset(SDLContext* context, GameState* state)
 			capsule.center1.y =  1.0f ;
 			capsule.center2.y =  0.5f;
 
-			entity->physics_data.body_id = itu_sys_physics_add_body(entity, &body_def);
+			entity->physics_data.body_id = itu_sys_physics_add_body_untyped(entity, &body_def);
 			b2CreateCapsuleShape(entity->physics_data.body_id, &shape_def, &capsule);
 		}
 	}
@@ -252,7 +252,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		body_def.name = "terrain";
 		Entity* entity = entity_create(state);
 		
-		entity->physics_data.body_id = itu_sys_physics_add_body(entity, &body_def);
+		entity->physics_data.body_id = itu_sys_physics_add_body_untyped(entity, &body_def);
 		add_terrain_piece(entity->physics_data.body_id, vec2f { 32, 0.5f }, vec2f { 0, -0.5f }, 0); // ground
 		add_terrain_piece(entity->physics_data.body_id, vec2f { 3, 0.5f }, vec2f { 7, 6 }, PI_HALF); // wall
 	}
@@ -277,7 +277,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		b2Polygon polygon = b2MakeOffsetBox(1.5f, 0.5f, b2Vec2_zero, b2MakeRot(PI_HALF));
 
 
-		entity->physics_data.body_id = itu_sys_physics_add_body(entity, &body_def);
+		entity->physics_data.body_id = itu_sys_physics_add_body_untyped(entity, &body_def);
 		b2CreatePolygonShape(entity->physics_data.body_id, &shape_def, &polygon);
 
 		itu_lib_sprite_init(
@@ -440,6 +440,7 @@ static void game_update_post_physics(SDLContext* context, GameState* state)
 static void game_render(SDLContext* context, GameState* state)
 {
 	// entities
+	itu_lib_sprite_batch_begin(context);
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
@@ -448,11 +449,12 @@ static void game_render(SDLContext* context, GameState* state)
 		SDL_FRect rect_dst;
 
 		if(DEBUG_render_textures)
-			itu_lib_sprite_render(context, &entity->sprite, &entity->transform);
+			itu_lib_sprite_batch_add(context, &entity->sprite, &entity->transform);
 
 		if(DEBUG_render_outlines)
 			itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
 	}
+	itu_lib_sprite_batch_end(context);
 
 	if(DEBUG_physics)
 		itu_sys_physics_debug_draw();
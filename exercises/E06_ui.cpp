@@ -391,7 +391,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		physics_data.ignore_rotation = true;
 		body_def.position = value_cast(b2Vec2, transform.position);
 		body_def.type = b2_dynamicBody;
-		physics_data.body_id = itu_sys_physics_add_body(value_cast(void*, id_player), &body_def);
+		physics_data.body_id = itu_sys_physics_add_body(id_player, &body_def);
 		
 		ShapeData shape_data;
 		shape_data.shape_id = b2CreateCircleShape(physics_data.body_id, &shape_def, &circle);
@@ -432,7 +432,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		PhysicsStaticData physics_data = { 0 };
 		body_def.position = value_cast(b2Vec2, transform.position);
 		body_def.type = b2_staticBody;
-		physics_data.body_id = itu_sys_physics_add_body(value_cast(void*, id), &body_def);
+		physics_data.body_id = itu_sys_physics_add_body(id, &body_def);
 
 		
 		ShapeData shape_data;
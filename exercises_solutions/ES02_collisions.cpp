@@ -584,6 +584,8 @@ static void game_update(MySDLContext* context, GameState* state)
 static void game_render(MySDLContext* context, GameState* state)
 {
 	// render
+	// NOTE: collider outlines are accumulated and drawn all together at the end (a couple of draw calls instead of a few per entity)
+	itu_lib_render_debug_begin();
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
@@ -600,6 +602,7 @@ static void game_render(MySDLContext* context, GameState* state)
 			);
 		}
 	}
+	itu_lib_render_debug_end(context->renderer);
 
 	// debug world partition
 	{
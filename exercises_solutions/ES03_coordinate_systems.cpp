@@ -64,16 +64,12 @@ struct Entity
 
 // NOTE at the moment, we are treanting the tilemap as an entirely independent thing,
 //      even if it could share some funcitonlity wit other entities. We will refine this later
+// NOTE: tile storage and rendering are handled by the engine `Tilemap`, which bakes tiles in chunks
+//       so that we don't have to draw each tile every frame
 struct EntityTilemap
 {
 	Transform transform;
-
-	SDL_Texture* texture;
-	int num_rows;
-	int num_cols;
-	int tile_size;
-
-	int* tile_ids;
+	Tilemap   tilemap;
 };
 
 struct GameState
@@ -121,11 +117,25 @@ static void entity_destroy(GameState* state, Entity* entity)
 vec2f tilemap_point_world_to_tilemap(EntityTilemap* tilemap, vec2f p)
 {
 	vec2f ret;
-	ret.x = p.x / (tilemap->transform.scale.x * tilemap->tile_size / TEXTURE_PIXELS_PER_UNIT) - tilemap->transform.position.x + 0.5f;
-	ret.y = p.y / (tilemap->transform.scale.y * tilemap->tile_size / TEXTURE_PIXELS_PER_UNIT) - tilemap->transform.position.y + 0.5f;
+	ret.x = p.x / (tilemap->transform.scale.x * tilemap->tilemap.tile_size / TEXTURE_PIXELS_PER_UNIT) - tilemap->transform.position.x + 0.5f;
+	ret.y = p.y / (tilemap->transform.scale.y * tilemap->tilemap.tile_size / TEXTURE_PIXELS_PER_UNIT) - tilemap->transform.position.y + 0.5f;
 	return ret;
 }
 
+// draws a single tile of the tilemap directly (ie, to highlight it)
+static void ex3_render_tile_tinted(SDLContext* context, EntityTilemap* tilemap, int x, int y, color tint)
+{
+	Uint16 tile = itu_lib_tilemap_get_tile(&tilemap->tilemap, x, y);
+	if(tile == TILEMAP_TILE_EMPTY)
+		return;
+
+	SDL_FRect rect_src = itu_lib_tilemap_get_tile_rect_src(&tilemap->tilemap, tile);
+	SDL_FRect rect_dst = rect_global_to_screen(context, itu_lib_tilemap_get_tile_rect(&tilemap->tilemap, &tilemap->transform, x, y));
+
+	sdl_set_texture_tint(tilemap->tilemap.tileset, tint);
+	SDL_RenderTexture(context->renderer, tilemap->tilemap.tileset, &rect_src, &rect_dst);
+}
+
 static void game_init(SDLContext* context, GameState* state)
 {
 	// allocate memory
@@ -137,6 +147,16 @@ static void game_init(SDLContext* context, GameState* state)
 	// texture atlases
 	state->atlas = texture_create(context, "data/kenney/tiny_dungeon_packed.png", SDL_SCALEMODE_NEAREST);
 	state->bg    = texture_create(context, "data/kenney/prototype_texture_dark/texture_13.png", SDL_SCALEMODE_LINEAR);
+
+	// tilemap data (converted from map ids to tileset ids once, here)
+	{
+		const int num_rows = array_size(tile_ids);
+		const int num_cols = array_size(tile_ids[0]);
+		itu_lib_tilemap_init(&state->tilemap.tilemap, state->atlas, TILESET_NUM_COLS, 16, num_cols, num_rows);
+		for(int y = 0; y < num_rows; ++y)
+			for(int x = 0; x < num_cols; ++x)
+				itu_lib_tilemap_set_tile(&state->tilemap.tilemap, x, y, tile_mapping[tile_ids[y][x]]);
+	}
 }
 
 static void game_reset(SDLContext* context, GameState* state)
@@ -159,11 +179,6 @@ static void game_reset(SDLContext* context, GameState* state)
 	{
 		state->tilemap.transform.position = VEC2F_ZERO;
 		state->tilemap.transform.scale = VEC2F_ONE;
-		state->tilemap.texture = state->atlas;
-		state->tilemap.num_rows = 14;
-		state->tilemap.num_cols = 11;
-		state->tilemap.tile_size = 16;
-		state->tilemap.tile_ids = (int*)tile_ids;
 	}
 }
 
@@ -219,40 +234,27 @@ static void game_render(SDLContext* context, GameState* state)
 		vec2f player_min_tilemap = tilemap_point_world_to_tilemap(tilemap, state->player->transform.position - mul_element_wise(player_size_world, state->player->sprite.pivot));
 		vec2f player_max_tilemap = tilemap_point_world_to_tilemap(tilemap, state->player->transform.position + mul_element_wise(player_size_world, one_minus_pivot));
 
-		// we could hve each tile being an independent entity, be let's do something more clever
-		for(int y = 0; y < tilemap->num_rows; ++y)
+		// we could hve each tile being an independent entity, be let's do something more clever:
+		// the tilemap draws one pre-baked texture per visible chunk, instead of one texture per tile
+		itu_lib_tilemap_render(context, &tilemap->tilemap, &tilemap->transform);
+
+		// highlighted tiles are drawn again on top of the tilemap, tinted.
+		// Only the tiles around the player can be highlighted, so we don't need to check the whole map
+		int highlight_min_x = (int)SDL_floorf(player_min_tilemap.x - 1);
+		int highlight_min_y = (int)SDL_floorf(player_min_tilemap.y - 1);
+		int highlight_max_x = (int)SDL_ceilf (player_max_tilemap.x);
+		int highlight_max_y = (int)SDL_ceilf (player_max_tilemap.y);
+		for(int y = highlight_min_y; y <= highlight_max_y; ++y)
 		{
-			for(int x = 0; x < tilemap->num_cols; ++x)
+			for(int x = highlight_min_x; x <= highlight_max_x; ++x)
 			{
-				// get tile coords from tile id in the map and tile-id mapping
-				int tile_id_map = tilemap->tile_ids[y * tilemap->num_cols + x];
-				int tile_id_texture = tile_mapping[tile_id_map];
-				int tile_coord_x = tile_id_texture % TILESET_NUM_COLS;
-				int tile_coord_y = tile_id_texture / TILESET_NUM_COLS;
-
-				// get source rect from texture size and tile coords
-				SDL_FRect rect_src;
-				rect_src.w = tilemap->tile_size;
-				rect_src.h = tilemap->tile_size;
-				rect_src.x = tile_coord_x * rect_src.w;
-				rect_src.y = tile_coord_y * rect_src.h;
-
-				// get destination rect based on current x and y
-				SDL_FRect rect_dst;
-				rect_dst.w = tilemap->transform.scale.x * (tilemap->tile_size / (float)TEXTURE_PIXELS_PER_UNIT);
-				rect_dst.h = tilemap->transform.scale.y * (tilemap->tile_size / (float)TEXTURE_PIXELS_PER_UNIT);
-				rect_dst.x = tilemap->transform.position.x + rect_dst.w * (x + tile_offset); // NOTE: offsetting the destination rect to center the tile
-				rect_dst.y = tilemap->transform.position.y + rect_dst.h * (y + tile_offset); // NOTE: offsetting the destination rect to center the tile
-				rect_dst = rect_global_to_screen(context, rect_dst);
-
-				// set tile tint
-				color tile_tint = COLOR_WHITE;
-				// check mouse pos
+				// mouse is drawn last (so that it's always visible)
 				if(mouse_coord_x == x && mouse_coord_y == y)
-					tile_tint = COLOR_RED;
+					continue;
 
+				color tile_tint;
 				// check player center pos
-				else if(player_coord_x == x && player_coord_y == y)
+				if(player_coord_x == x && player_coord_y == y)
 					tile_tint = COLOR_GREEN;
 
 				// check player extents
@@ -261,14 +263,20 @@ static void game_render(SDLContext* context, GameState* state)
 					y > player_min_tilemap.y - 0.5f + tile_offset && y < player_max_tilemap.y + 0.5f + tile_offset
 				)
 					tile_tint = COLOR_BLUE;
+				else
+					continue;
 
-				SDL_SetTextureColorModFloat(tilemap->texture, tile_tint.r, tile_tint.g, tile_tint.b);
-				SDL_RenderTexture(context->renderer, tilemap->texture, &rect_src, &rect_dst);
+				ex3_render_tile_tinted(context, tilemap, x, y, tile_tint);
 			}
 		}
+
+		// check mouse pos
+		ex3_render_tile_tinted(context, tilemap, mouse_coord_x, mouse_coord_y, COLOR_RED);
+		sdl_set_texture_tint(tilemap->tilemap.tileset, COLOR_WHITE);
 	}
 
 	// entities
+	itu_lib_sprite_batch_begin(context);
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
@@ -277,11 +285,12 @@ static void game_render(SDLContext* context, GameState* state)
 		SDL_FRect rect_dst;
 
 		if(DEBUG_render_textures)
-			itu_lib_sprite_render(context, &entity->sprite, &entity->transform);
+			itu_lib_sprite_batch_add(context, &entity->sprite, &entity->transform);
 
 		if(DEBUG_render_outlines)
 			itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
 	}
+	itu_lib_sprite_batch_end(context);
 
 	// debug mouse
 	if(DEBUG_render_outlines)
@@ -295,6 +295,7 @@ static void game_render(SDLContext* context, GameState* state)
 	itu_lib_render_draw_world_grid(context);
 	
 	// entities
+	itu_lib_sprite_batch_begin(context);
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
@@ -303,11 +304,12 @@ static void game_render(SDLContext* context, GameState* state)
 		SDL_FRect rect_dst;
 
 		if(DEBUG_render_textures)
-			itu_lib_sprite_render(context, &entity->sprite, &entity->transform);
+			itu_lib_sprite_batch_add(context, &entity->sprite, &entity->transform);
 
 		if(DEBUG_render_outlines)
 			itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
 	}
+	itu_lib_sprite_batch_end(context);
 
 	if(DEBUG_physics)
 		b2World_Draw(state->world_id, &debug_draw);
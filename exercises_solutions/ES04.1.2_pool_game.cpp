@@ -70,9 +70,7 @@ struct GameState
 
 	// box2d
 	b2WorldId world_id;
-	// hashmap to retrieve entity from bodyId (which is the only thing we have when handling collision ovents from b2d)
-	// NOTE: I (chris) used an hashmap to test viability in future exercises. An array + linear search would have been more than enough for our current needs)
-	struct { b2BodyId key; Entity* value; } *map_b2body_entity;
+	// NOTE: entities are stored as body user data, to retrieve them from bodyId (which is the only thing we have when handling collision events from b2d)
 };
 
 
@@ -97,8 +95,9 @@ static Entity* entity_create(GameState* state)
 
 static void entity_add_physics_body(GameState* state, Entity* entity, b2BodyDef* body_def)
 {
-	entity->body_id = b2CreateBody(state->world_id, body_def);
-	hmput(state->map_b2body_entity, entity->body_id, entity);
+	b2BodyDef body_def_curr = *body_def;
+	body_def_curr.userData = entity;
+	entity->body_id = b2CreateBody(state->world_id, &body_def_curr);
 }
 
 // NOTE: this only works if nobody holds references to other entities!
@@ -110,7 +109,6 @@ static void entity_destroy(GameState* state, Entity* entity)
 	SDL_assert(entity >= state->entities && entity < state->entities + ENTITY_COUNT);
 
 	b2DestroyBody(entity->body_id);
-	hmdel(state->map_b2body_entity, entity->body_id);
 	entity->alive = false;
 }
 
@@ -181,9 +179,6 @@ static void game_reset(SDLContext* context, GameState* state)
 	
 	context->camera_active->zoom = 0.2f;
 	
-	// reset body<>entity map
-	hmfree(state->map_b2body_entity);
-
 	// background
 	{
 		Entity* entity = entity_create(state);
@@ -422,7 +417,7 @@ static void game_update_post_physics(SDLContext* context, GameState* state)
 			if(filter_sensor.categoryBits == COLLISION_FILTER_HOLE && filter_visitor.categoryBits == COLLISION_FILTER_BALL)
 			{
 				b2BodyId body_id = b2Shape_GetBody(sensor_data->visitorShapeId);
-				Entity* entity = hmget(state->map_b2body_entity, body_id);
+				Entity* entity = (Entity*)b2Body_GetUserData(body_id);
 				if(!entity)
 				{
 					SDL_Log("error!");
@@ -439,6 +434,7 @@ static void game_render(SDLContext* context, GameState* state)
 	itu_lib_render_draw_world_grid(context);
 	
 	// entities
+	itu_lib_sprite_batch_begin(context);
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
@@ -450,11 +446,12 @@ static void game_render(SDLContext* context, GameState* state)
 		SDL_FRect rect_dst;
 
 		if(DEBUG_render_textures)
-			itu_lib_sprite_render(context, &entity->sprite, &entity->transform);
+			itu_lib_sprite_batch_add(context, &entity->sprite, &entity->transform);
 
 		if(DEBUG_render_outlines)
 			itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
 	}
+	itu_lib_sprite_batch_end(context);
 
 	// player aim
 	{
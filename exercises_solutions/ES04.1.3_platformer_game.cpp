@@ -116,9 +116,7 @@ struct GameState
 
 	// box2d
 	b2WorldId world_id;
-	// hashmap to retrieve entity from bodyId (which is the only thing we have when handling collision ovents from b2d)
-	// NOTE: I (chris) used an hashmap to test viability in future exercises. An array + linear search would have been more than enough for our current needs)
-	struct { b2BodyId key; Entity* value; } *map_b2body_entity;
+	// NOTE: entities are stored as body user data, to retrieve them from bodyId (which is the only thing we have when handling collision events from b2d)
 };
 
 static Entity* entity_create(GameState* state)
@@ -137,13 +135,14 @@ static Entity* entity_create(GameState* state)
 
 static void entity_add_physics_body(GameState* state, Entity* entity, b2BodyDef* body_def)
 {
-	entity->body_id = b2CreateBody(state->world_id, body_def);
-	stbds_hmput(state->map_b2body_entity,entity->body_id,entity);
+	b2BodyDef body_def_curr = *body_def;
+	body_def_curr.userData = entity;
+	entity->body_id = b2CreateBody(state->world_id, &body_def_curr);
 }
 
 static Entity* entity_get_from_body(GameState* state, b2BodyId body_id)
 {
-	return stbds_hmget(state->map_b2body_entity,body_id);
+	return (Entity*)b2Body_GetUserData(body_id);
 }
 
 void debug_ui_player_data(GameState* state)
@@ -237,7 +236,6 @@ static void game_reset(SDLContext* context, GameState* state)
 	state->world_id = b2CreateWorld(&def_world);
 
 	state->entities_alive_count = 0;
-	stbds_hmfree(state->map_b2body_entity);
 
 	// player
 	{
@@ -724,6 +722,7 @@ static void game_render(SDLContext* context, GameState* state)
 	//itu_lib_render_draw_world_grid(context);
 	
 	// entities
+	itu_lib_sprite_batch_begin(context);
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
@@ -732,11 +731,12 @@ static void game_render(SDLContext* context, GameState* state)
 		SDL_FRect rect_dst;
 
 		if(DEBUG_render_textures)
-			itu_lib_sprite_render(context, &entity->sprite, &entity->transform);
+			itu_lib_sprite_batch_add(context, &entity->sprite, &entity->transform);
 
 		if(DEBUG_render_outlines)
 			itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
 	}
+	itu_lib_sprite_batch_end(context);
 
 	if(DEBUG_physics)
 		b2World_Draw(state->world_id, &debug_draw);
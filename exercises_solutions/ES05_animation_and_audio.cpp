@@ -336,7 +336,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		body_def.name = "terrain";
 		Entity* entity = entity_create(state);
 		
-		entity->physics_data.body_id = itu_sys_physics_add_body(entity, &body_def);
+		entity->physics_data.body_id = itu_sys_physics_add_body_untyped(entity, &body_def);
 		add_terrain_piece(entity->physics_data.body_id, vec2f { 32, 0.5f }, vec2f { 0, -0.5f }, 0); // ground
 		add_terrain_piece(entity->physics_data.body_id, vec2f { 3, 0.5f }, vec2f { 7, 6 }, PI_HALF); // wall
 	}
@@ -414,16 +414,18 @@ static void game_render(SDLContext* context, GameState* state)
 	itu_lib_render_draw_world_grid(context);
 
 	// entities
+	itu_lib_sprite_batch_begin(context);
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
 
 		if(DEBUG_render_textures)
-			itu_lib_sprite_render(context, &entity->sprite, &entity->transform);
+			itu_lib_sprite_batch_add(context, &entity->sprite, &entity->transform);
 
 		if(DEBUG_render_outlines)
 			itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
 	}
+	itu_lib_sprite_batch_end(context);
 
 	if(DEBUG_physics)
 		itu_sys_physics_debug_draw();
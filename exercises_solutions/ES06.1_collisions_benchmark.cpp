@@ -0,0 +1,332 @@
+// ES06.1 - collisions benchmark
+// stress scene for `itu_sys_collisions`: a crowd of 20k colliders (circles, axis aligned rects and rotating polygons)
+// bouncing around inside a walled arena, with a few static obstacles in the middle.
+// Nothing is rendered except the debug draw of the collision system, so that the numbers are about collisions only
+// (debug draw can be disabled from the debug UI, and is off by default in headless mode)
+#define TEXTURE_PIXELS_PER_UNIT 128 // how many pixels of textures will be mapped to a single world unit
+#define CAMERA_PIXELS_PER_UNIT  5   // how many pixels of windows will be used to render a single world unit
+
+#define ENABLE_DIAGNOSTICS
+
+// rendering framerate
+#define TARGET_FRAMERATE_NS     (SECONDS(1) / 60)
+
+// physics timestep (unused, but required by the engine)
+#define PHYSICS_TIMESTEP_NSECS  (SECONDS(1) / 60)
+#define PHYSICS_TIMESTEP_SECS   NS_TO_SECONDS(PHYSICS_TIMESTEP_NSECS)
+#define PHYSICS_MAX_TIMESTEPS_PER_FRAME 4
+
+#define WINDOW_W         1280
+#define WINDOW_H         720
+
+// NOTE: the default limit (16k) is not enough for this scene
+#define ENTITIES_COUNT_MAX (4096 * 6)
+
+#include <itu_unity_include.hpp>
+
+#define COLLIDERS_COUNT     20000
+#define OBSTACLES_COUNT     16
+#define ARENA_HALF_SIZE     60.0f
+#define COLLIDER_SIZE_MIN   0.2f
+#define COLLIDER_SIZE_MAX   0.35f
+#define COLLIDER_SPEED_MAX  4.0f
+
+struct EX61_Mover
+{
+	vec2f velocity;
+	float velocity_angular;
+};
+register_component(EX61_Mover)
+
+struct GameState
+{
+	bool debug_draw;
+
+	// accumulated over the whole run, printed at the end in headless mode
+	int   collisions_frames_count;
+	float collisions_ms_tot;
+	float collisions_ms_min;
+	float collisions_ms_max;
+};
+
+static vec2f ex61_random_in_arena(float margin)
+{
+	vec2f ret;
+	ret.x = (SDL_randf() * 2 - 1) * (ARENA_HALF_SIZE - margin);
+	ret.y = (SDL_randf() * 2 - 1) * (ARENA_HALF_SIZE - margin);
+	return ret;
+}
+
+static Collider ex61_make_random_collider(int i)
+{
+	float size = COLLIDER_SIZE_MIN + SDL_randf() * (COLLIDER_SIZE_MAX - COLLIDER_SIZE_MIN);
+	switch(i % 3)
+	{
+		case 0: return itu_sys_collisions_make_circle(size);
+		case 1: return itu_sys_collisions_make_rect(vec2f{ size, size * (0.5f + SDL_randf()) });
+		default:
+		{
+			// regular polygon, from triangles to hexagons
+			vec2f vertices[6];
+			int vertices_count = 3 + SDL_rand(4);
+			for(int j = 0; j < vertices_count; ++j)
+			{
+				float angle = (float)j / vertices_count * 2 * PI;
+				vertices[j] = vec2f{ SDL_cosf(angle), SDL_sinf(angle) } * size;
+			}
+			return itu_sys_collisions_make_polygon(vertices, vertices_count);
+		}
+	}
+}
+
+// moves entities around, bouncing them back when they reach the arena walls
+// NOTE: this runs after `itu_system_collisions` (standard systems are registered first), so the separation
+//       happens on next frame. At this speed it's not noticeable
+static void ex61_system_move(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
+{
+	const float limit = ARENA_HALF_SIZE - 1.0f - COLLIDER_SIZE_MAX;
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		ITU_EntityId id = entity_ids[i];
+		Transform*  transform = entity_get_data(id, Transform);
+		EX61_Mover* mover     = entity_get_data(id, EX61_Mover);
+
+		transform->position = transform->position + mover->velocity * context->delta;
+		transform->rotation += mover->velocity_angular * context->delta;
+
+		if((transform->position.x < -limit && mover->velocity.x < 0) || (transform->position.x > limit && mover->velocity.x > 0))
+			mover->velocity.x = -mover->velocity.x;
+		if((transform->position.y < -limit && mover->velocity.y < 0) || (transform->position.y > limit && mover->velocity.y > 0))
+			mover->velocity.y = -mover->velocity.y;
+	}
+}
+
+static void game_init(SDLContext* context, GameState* state)
+{
+	itu_sys_estorage_init(COLLIDERS_COUNT + OBSTACLES_COUNT + 4);
+	itu_sys_physics_init(context);
+
+	enable_component(EX61_Mover);
+
+	// average collider is ~0.55 units wide, so cells of one unit are a bit more than twice the size of the most common collider
+	itu_sys_collisions_set_cell_size(1.0f);
+
+	add_system(ex61_system_move, component_mask(Transform) | component_mask(Collider) | component_mask(EX61_Mover), 0);
+}
+
+static void game_reset(SDLContext* context, GameState* state)
+{
+	// fixed seed, so that runs are comparable
+	SDL_srand(0);
+
+	// walls
+	{
+		vec2f positions[4]  = { { 0, ARENA_HALF_SIZE }, { 0, -ARENA_HALF_SIZE }, { -ARENA_HALF_SIZE, 0 }, { ARENA_HALF_SIZE, 0 } };
+		vec2f half_sizes[4] = { { ARENA_HALF_SIZE + 1, 1 }, { ARENA_HALF_SIZE + 1, 1 }, { 1, ARENA_HALF_SIZE + 1 }, { 1, ARENA_HALF_SIZE + 1 } };
+		for(int i = 0; i < 4; ++i)
+		{
+			ITU_EntityId id = itu_entity_create();
+			Transform transform = { 0 };
+			transform.position = positions[i];
+			transform.scale = VEC2F_ONE;
+
+			Collider collider = itu_sys_collisions_make_rect(half_sizes[i]);
+			collider.is_static = true;
+
+			entity_add_component(id, Transform, transform);
+			entity_add_component(id, Collider, collider);
+		}
+	}
+
+	// obstacles
+	for(int i = 0; i < OBSTACLES_COUNT; ++i)
+	{
+		ITU_EntityId id = itu_entity_create();
+		Transform transform = { 0 };
+		transform.position = ex61_random_in_arena(ARENA_HALF_SIZE * 0.25f);
+		transform.scale = VEC2F_ONE;
+
+		Collider collider = itu_sys_collisions_make_circle(2.0f + SDL_randf() * 2.0f);
+		collider.is_static = true;
+
+		entity_add_component(id, Transform, transform);
+		entity_add_component(id, Collider, collider);
+	}
+
+	// crowd
+	{
+		ITU_EntityId* ids = (ITU_EntityId*)SDL_malloc(COLLIDERS_COUNT * sizeof(ITU_EntityId));
+		itu_entity_create_batch(ids, COLLIDERS_COUNT);
+		for(int i = 0; i < COLLIDERS_COUNT; ++i)
+		{
+			Transform transform = { 0 };
+			transform.position = ex61_random_in_arena(1.0f + COLLIDER_SIZE_MAX);
+			transform.scale = VEC2F_ONE;
+
+			Collider collider = ex61_make_random_collider(i);
+
+			EX61_Mover mover;
+			mover.velocity = ex61_random_in_arena(0) * (COLLIDER_SPEED_MAX / ARENA_HALF_SIZE);
+			mover.velocity_angular = collider.type == COLLIDER_POLYGON ? (SDL_randf() * 2 - 1) * PI : 0;
+
+			entity_add_component(ids[i], Transform, transform);
+			entity_add_component(ids[i], Collider, collider);
+			entity_add_component(ids[i], EX61_Mover, mover);
+		}
+		SDL_free(ids);
+	}
+
+	state->collisions_frames_count = 0;
+	state->collisions_ms_tot = 0;
+	state->collisions_ms_min = 1000;
+	state->collisions_ms_max = 0;
+}
+
+// usage: ES06.1_collisions_benchmark [--headless [frame_count]]
+// headless mode runs a fixed number of frames as fast as possible with the software renderer and no window,
+// then prints timing statistics of the collision system
+int main(int argc, char** argv)
+{
+	bool quit = false;
+	SDLContext context = { 0 };
+	GameState  state   = { };
+
+	bool headless = false;
+	int headless_frames = 600;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(SDL_strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+			if(i + 1 < argc && SDL_isdigit(argv[i + 1][0]))
+				headless_frames = SDL_atoi(argv[++i]);
+		}
+	}
+
+	context.window_w = WINDOW_W;
+	context.window_h = WINDOW_H;
+
+	TTF_Init();
+
+	context.working_dir = SDL_GetCurrentDirectory();
+	if(!sdl_context_create_window(&context, "ES06.1 - collisions benchmark", WINDOW_W, WINDOW_H, headless ? NULL : "vulkan", headless))
+		return 1;
+
+	itu_lib_imgui_setup(context.window, &context, true);
+
+	context.camera_default.normalized_screen_size.x = 1.0f;
+	context.camera_default.normalized_screen_size.y = 1.0f;
+	context.camera_default.zoom = 1;
+	context.camera_default.pixels_per_unit = CAMERA_PIXELS_PER_UNIT;
+	camera_set_active(&context, &context.camera_default);
+
+	context.debug_ui_show = !headless;
+	state.debug_draw = !headless;
+
+	game_init(&context, &state);
+	game_reset(&context, &state);
+
+	SDL_Time walltime_frame_beg;
+	SDL_Time walltime_frame_end;
+	SDL_Time walltime_work_end;
+	SDL_Time elapsed_work = 0;
+	SDL_Time elapsed_frame = 0;
+
+	SDL_GetCurrentTime(&walltime_frame_beg);
+	walltime_frame_end = walltime_frame_beg;
+
+	// headless benchmark statistics
+	int frames_count = 0;
+	SDL_Time elapsed_work_tot = 0;
+	SDL_Time elapsed_work_min = SECONDS(1000);
+	SDL_Time elapsed_work_max = 0;
+
+	while(!quit)
+	{
+		quit = sdl_process_events(&context);
+
+		SDL_SetRenderDrawColor(context.renderer, 0x00, 0x00, 0x00, 0x00);
+		SDL_RenderClear(context.renderer);
+
+		itu_lib_imgui_frame_begin();
+
+		// update
+		itu_sys_estorage_systems_update(&context);
+
+		CollisionsStats collisions_stats = itu_sys_collisions_get_stats();
+		state.collisions_frames_count++;
+		state.collisions_ms_tot += collisions_stats.update_ms;
+		state.collisions_ms_min = SDL_min(state.collisions_ms_min, collisions_stats.update_ms);
+		state.collisions_ms_max = SDL_max(state.collisions_ms_max, collisions_stats.update_ms);
+
+		if(state.debug_draw)
+			itu_sys_collisions_debug_draw(&context);
+
+#ifdef ENABLE_DIAGNOSTICS
+		if(context.debug_ui_show)
+		{
+			if(ImGui::Begin("Debug UI", &context.debug_ui_show, ImGuiWindowFlags_NoCollapse))
+			{
+				ImGui::Text("Timing");
+				ImGui::LabelText("work", "%6.3f ms/f", (float)elapsed_work  / (float)MILLIS(1));
+				ImGui::LabelText("tot",  "%6.3f ms/f", (float)elapsed_frame / (float)MILLIS(1));
+
+				ImGui::Text("Collisions");
+				ImGui::LabelText("colliders",     "%d", collisions_stats.colliders_count);
+				ImGui::LabelText("cells entries", "%d", collisions_stats.cells_entries_count);
+				ImGui::LabelText("pairs tested",  "%d", collisions_stats.pairs_tested_count);
+				ImGui::LabelText("contacts",      "%d", collisions_stats.contacts_count);
+				ImGui::LabelText("update",        "%6.3f ms", collisions_stats.update_ms);
+				ImGui::LabelText("update (avg)",  "%6.3f ms", state.collisions_ms_tot / state.collisions_frames_count);
+				ImGui::Checkbox("debug draw", &state.debug_draw);
+			}
+			ImGui::End();
+		}
+#endif
+
+		itu_lib_imgui_frame_end(&context);
+
+		SDL_GetCurrentTime(&walltime_work_end);
+		elapsed_work = walltime_work_end - walltime_frame_beg;
+
+		if(!headless && elapsed_work < TARGET_FRAMERATE_NS)
+			SDL_DelayNS(TARGET_FRAMERATE_NS - elapsed_work);
+
+		SDL_GetCurrentTime(&walltime_frame_end);
+		elapsed_frame = walltime_frame_end - walltime_frame_beg;
+
+		// render
+		sdl_context_present(&context);
+
+		if(headless)
+		{
+			SDL_GetCurrentTime(&walltime_frame_end);
+			elapsed_work = walltime_frame_end - walltime_frame_beg;
+			elapsed_work_tot += elapsed_work;
+			elapsed_work_min = SDL_min(elapsed_work_min, elapsed_work);
+			elapsed_work_max = SDL_max(elapsed_work_max, elapsed_work);
+			frames_count++;
+			if(frames_count >= headless_frames)
+				quit = true;
+
+			// simulate at the target framerate regardless of how long frames take, so that runs are reproducible
+			elapsed_frame = TARGET_FRAMERATE_NS;
+		}
+
+		context.delta = (float)elapsed_frame / (float)SECONDS(1);
+		context.uptime += context.delta;
+		context.elapsed_frame = elapsed_frame;
+		walltime_frame_beg = walltime_frame_end;
+	}
+
+	if(headless && frames_count > 0)
+	{
+		CollisionsStats collisions_stats = itu_sys_collisions_get_stats();
+		SDL_Log("headless benchmark: %d frames (%s)\n", frames_count, SDL_GetRendererName(context.renderer));
+		SDL_Log("  work avg %6.3f ms/f\n", (float)elapsed_work_tot / frames_count / (float)MILLIS(1));
+		SDL_Log("  work min %6.3f ms/f\n", (float)elapsed_work_min / (float)MILLIS(1));
+		SDL_Log("  work max %6.3f ms/f\n", (float)elapsed_work_max / (float)MILLIS(1));
+		SDL_Log("  collisions avg %6.3f ms/f, min %6.3f ms/f, max %6.3f ms/f\n", state.collisions_ms_tot / state.collisions_frames_count, state.collisions_ms_min, state.collisions_ms_max);
+		SDL_Log("  collisions %d colliders, %d cells entries, %d pairs tested, %d contacts (last frame)\n", collisions_stats.colliders_count, collisions_stats.cells_entries_count, collisions_stats.pairs_tested_count, collisions_stats.contacts_count);
+	}
+}
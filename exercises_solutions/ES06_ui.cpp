@@ -34,6 +34,15 @@ enum EX6_Tags
 	TAG_ASTEROID
 };
 
+// render queue layers
+enum EX6_Layers
+{
+	EX6_LAYER_WORLD,
+	EX6_LAYER_PLAYER,
+	EX6_LAYER_UI,
+	EX6_LAYER_UI_TEXT,
+};
+
 struct EX6_PlayerData
 {
 	float curr_speed_linear;
@@ -54,6 +63,9 @@ struct EX6_HealthRenderer
 {
 	float widget_base_w;
 	ITU_EntityId target;
+
+	TTF_Font* label_font;
+	float     label_size;
 };
 register_component(EX6_HealthRenderer)
 
@@ -82,15 +94,29 @@ struct EX6_ImageButton
 	TTF_Text* ttf_text; // owned
 
 	void (*fn_callback_hover)(SDLContext* context, ITU_EntityId id);
-	void (*fn_callback_click)(SDLContext* context, ITU_EntityId id);
 };
 register_component(EX6_ImageButton)
 
+// pushed by `ex6_system_imagebutton`, read next frame by any system interested in clicks
+struct EX6_EventButtonClicked
+{
+	ITU_EntityId id;
+};
+register_event(EX6_EventButtonClicked)
+
 
 static ITU_EntityId id_player;
 
 static TTF_TextEngine* ttf_engine;
 
+// UI layers are cached (see `game_init()`), so anything that changes how a widget looks needs to call this
+// NOTE: it must happen before the widgets are pushed to the render queue, otherwise the change will show up next frame
+static void ex6_ui_mark_dirty()
+{
+	itu_lib_render_queue_invalidate_layer(EX6_LAYER_UI);
+	itu_lib_render_queue_invalidate_layer(EX6_LAYER_UI_TEXT);
+}
+
 // ============================================================================================
 // TMP methods
 // ============================================================================================
@@ -108,34 +134,46 @@ void ex6_system_camera_target(SDLContext* context, ITU_EntityId* entity_ids, int
 
 void ex6_lib_sprite_render_camera(SDLContext* context, Sprite* sprite, EX6_TransformScreen* transform)
 {
-	SDL_FRect rect_src = sprite->rect;
 	SDL_FRect rect_dst;
 
-	rect_dst.w = transform->scale.x * rect_src.w;
-	rect_dst.h = transform->scale.y * rect_src.h;
+	rect_dst.w = transform->scale.x * sprite->rect.w;
+	rect_dst.h = transform->scale.y * sprite->rect.h;
 	rect_dst.x = transform->position.x - sprite->pivot.x * rect_dst.w;
 	rect_dst.y = transform->position.y - sprite->pivot.y * rect_dst.h;
 
+	SDL_Vertex vs[4];
+	itu_lib_sprite_get_quad(sprite, rect_dst, transform->rotation, vs);
+	itu_lib_render_queue_push_quad(sprite->layer, transform->position.y, sprite->texture, vs);
+}
+
+struct EX6_Sprite9PatchDrawData
+{
+	EX6_Sprite9Patch sprite;
+	SDL_FRect        rect_dst;
+	float            scale;
+};
 
-	SDL_FPoint pivot_dst;
-	pivot_dst.x = sprite->pivot.x * rect_dst.w;
-	pivot_dst.y = sprite->pivot.y * rect_dst.h;
+void ex6_lib_sprite9patch_draw(SDLContext* context, void* data)
+{
+	EX6_Sprite9PatchDrawData* draw_data = (EX6_Sprite9PatchDrawData*)data;
+	EX6_Sprite9Patch* sprite = &draw_data->sprite;
 
 	sdl_set_texture_tint(sprite->texture, sprite->tint);
-	SDL_RenderTextureRotated(
+	SDL_RenderTexture9Grid(
 		context->renderer,
 		sprite->texture,
-		&rect_src,
-		&rect_dst,
-		(-transform->rotation) * RAD_2_DEG,
-		&pivot_dst,
-		sprite->flip_horizontal ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE
+		&sprite->rect,
+		sprite->margins_hor.x,
+		sprite->margins_hor.y,
+		sprite->margins_ver.x,
+		sprite->margins_ver.y,
+		draw_data->scale,
+		&draw_data->rect_dst
 	);
 }
 
 void ex6_lib_sprite9patch_render_camera(SDLContext* context, EX6_Sprite9Patch* sprite, EX6_TransformScreen* transform)
 {
-	SDL_FRect rect_src = sprite->rect;
 	SDL_FRect rect_dst;
 
 	rect_dst.w = transform->scale.x * sprite->size.x;
@@ -146,22 +184,12 @@ void ex6_lib_sprite9patch_render_camera(SDLContext* context, EX6_Sprite9Patch* s
 	rect_dst.w = SDL_max(rect_dst.w, sprite->margins_hor.x + sprite->margins_hor.y);
 	rect_dst.h = SDL_max(rect_dst.h, sprite->margins_ver.x + sprite->margins_ver.y);
 
-	SDL_FPoint pivot_dst;
-	pivot_dst.x = sprite->pivot.x * rect_dst.w;
-	pivot_dst.y = sprite->pivot.y * rect_dst.h;
-
-	sdl_set_texture_tint(sprite->texture, sprite->tint);
-	SDL_RenderTexture9Grid(
-		context->renderer,
-		sprite->texture,
-		&rect_src,
-		sprite->margins_hor.x,
-		sprite->margins_hor.y,
-		sprite->margins_ver.x,
-		sprite->margins_ver.y,
-		transform->scale.x,
-		&rect_dst
-	);
+	// 9-patches are not quads, so we let the render queue call us back when it's their turn
+	EX6_Sprite9PatchDrawData draw_data;
+	draw_data.sprite = *sprite;
+	draw_data.rect_dst = rect_dst;
+	draw_data.scale = transform->scale.x;
+	itu_lib_render_queue_push_callback(EX6_LAYER_UI, transform->position.y, sprite->texture, ex6_lib_sprite9patch_draw, &draw_data, sizeof(draw_data));
 }
 
 void ex6_system_sprite_render_camera(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
@@ -182,6 +210,10 @@ void ex6_system_sprite_render_camera(SDLContext* context, ITU_EntityId* entity_i
 
 void ex6_system_sprite9patch_render_camera(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
 {
+	// the cached texture is still valid, no need to push anything
+	if(!itu_lib_render_queue_layer_needs_redraw(EX6_LAYER_UI))
+		return;
+
 	for(int i = 0; i < entity_ids_count; ++i)
 	{
 		ITU_EntityId id = entity_ids[i];
@@ -192,8 +224,34 @@ void ex6_system_sprite9patch_render_camera(SDLContext* context, ITU_EntityId* en
 	}
 }
 
+struct EX6_TextDrawData
+{
+	TTF_Text* ttf_text;
+	float x;
+	float y;
+};
+
+void ex6_lib_text_draw(SDLContext* context, void* data)
+{
+	EX6_TextDrawData* draw_data = (EX6_TextDrawData*)data;
+	TTF_DrawRendererText(draw_data->ttf_text, draw_data->x, draw_data->y);
+}
+
+static SDL_FRect ex6_lib_imagebutton_get_rect(EX6_Sprite9Patch* sprite, EX6_TransformScreen* transform)
+{
+	SDL_FRect rect_dst;
+	rect_dst.w = transform->scale.x * sprite->size.x;
+	rect_dst.h = transform->scale.y * sprite->size.y;
+	rect_dst.x = transform->position.x - sprite->pivot.x * rect_dst.w;
+	rect_dst.y = transform->position.y - sprite->pivot.y * rect_dst.h;
+	return rect_dst;
+}
+
 void ex6_system_imagebutton(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
 {
+	vec2f mouse_camera_pos = point_window_to_screen(context, context->mouse_pos);
+
+	// update all buttons first, so that we know if the UI needs to be redrawn before pushing anything
 	for(int i = 0; i < entity_ids_count; ++i)
 	{
 		ITU_EntityId id = entity_ids[i];
@@ -201,20 +259,13 @@ void ex6_system_imagebutton(SDLContext* context, ITU_EntityId* entity_ids, int e
 		EX6_Sprite9Patch*    sprite      = entity_get_data(id, EX6_Sprite9Patch);
 		EX6_ImageButton*     imagebutton = entity_get_data(id, EX6_ImageButton);
 
-		SDL_FRect rect_dst;
-		rect_dst.w = transform->scale.x * sprite->size.x;
-		rect_dst.h = transform->scale.y * sprite->size.y;
-		rect_dst.x = transform->position.x - sprite->pivot.x * rect_dst.w;
-		rect_dst.y = transform->position.y - sprite->pivot.y * rect_dst.h;
+		SDL_FRect rect_dst = ex6_lib_imagebutton_get_rect(sprite, transform);
 
 		// // TMP debug btn area
 		//sdl_set_render_draw_color(context, COLOR_YELLOW);
 		//SDL_RenderRect(context->renderer, &rect_dst);
 
-		TTF_DrawRendererText(imagebutton->ttf_text, rect_dst.x, rect_dst.y);
-
-		vec2f mouse_camera_pos = point_window_to_screen(context, context->mouse_pos);
-
+		color tint_prev = sprite->tint;
 		if(SDL_PointInRectFloat((SDL_FPoint*)&mouse_camera_pos, &rect_dst))
 		{
 			sprite->tint = EX6_COLOR_BTN_HOVER;
@@ -224,14 +275,44 @@ void ex6_system_imagebutton(SDLContext* context, ITU_EntityId* entity_ids, int e
 			if(context->btn_isdown[BTN_TYPE_UI_SELECT])
 				sprite->tint = EX6_COLOR_BTN_CLICK;
 
-			if(context->btn_isjustpressed[BTN_TYPE_UI_SELECT] && imagebutton->fn_callback_click)
-				imagebutton->fn_callback_click(context, id);
+			if(context->btn_isjustpressed[BTN_TYPE_UI_SELECT])
+			{
+				EX6_EventButtonClicked event = { id };
+				events_push(EX6_EventButtonClicked, event);
+			}
 		}
 		else
 			sprite->tint = EX6_COLOR_BTN_DEFAULT;
+
+		if(SDL_memcmp(&tint_prev, &sprite->tint, sizeof(color)) != 0)
+			ex6_ui_mark_dirty();
+	}
+
+	// the cached texture is still valid, no need to push anything
+	if(!itu_lib_render_queue_layer_needs_redraw(EX6_LAYER_UI_TEXT))
+		return;
+
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		ITU_EntityId id = entity_ids[i];
+		EX6_TransformScreen* transform   = entity_get_data(id, EX6_TransformScreen);
+		EX6_Sprite9Patch*    sprite      = entity_get_data(id, EX6_Sprite9Patch);
+		EX6_ImageButton*     imagebutton = entity_get_data(id, EX6_ImageButton);
+
+		SDL_FRect rect_dst = ex6_lib_imagebutton_get_rect(sprite, transform);
+
+		EX6_TextDrawData text_draw_data = { imagebutton->ttf_text, rect_dst.x, rect_dst.y };
+		itu_lib_render_queue_push_callback(EX6_LAYER_UI_TEXT, rect_dst.y, NULL, ex6_lib_text_draw, &text_draw_data, sizeof(text_draw_data));
 	}
 }
 
+void ex6_system_button_clicked(SDLContext* context, void* events, int events_count)
+{
+	EX6_EventButtonClicked* events_clicked = (EX6_EventButtonClicked*)events;
+	for(int i = 0; i < events_count; ++i)
+		SDL_Log("click (entity %d)", events_clicked[i].id.index);
+}
+
 // ============================================================================================
 // COMPONENT DEBUG UI RENDER methods
 // ============================================================================================
@@ -260,12 +341,17 @@ void ex6_debug_ui_render_healthrenderer(SDLContext* context, void* data)
 
 	itu_debug_ui_widget_entityid("target", data_renderer->target);
 	ImGui::DragFloat("base widget width", &data_renderer->widget_base_w);
+	if(ImGui::DragFloat("label size", &data_renderer->label_size, 1, 4, 128))
+		ex6_ui_mark_dirty();
 }
 
 void ex6_debug_ui_render_transformscreen(SDLContext* context, void* data)
 {
 	EX6_TransformScreen* data_transform = (EX6_TransformScreen*)data;
 
+	// any field could be edited from here, just redraw the UI while it's inspected
+	ex6_ui_mark_dirty();
+
 	ImGui::DragFloat2("position", &data_transform->position.x);
 	ImGui::DragFloat2("scale", &data_transform->scale.x);
 
@@ -280,6 +366,8 @@ void ex6_debug_ui_render_sprite9patch(SDLContext* context, void* data)
 {
 	EX6_Sprite9Patch* data_sprite = (EX6_Sprite9Patch*)data;
 
+	ex6_ui_mark_dirty();
+
 	itu_sys_rstorage_debug_render_texture(data_sprite->texture, &data_sprite->texture, &data_sprite->rect);
 
 	ImGui::DragFloat4("texture rect", &data_sprite->rect.x);
@@ -296,12 +384,13 @@ void ex6_debug_ui_render_sprite9patch(SDLContext* context, void* data)
 void ex6_debug_ui_render_imagebutton(SDLContext* context, void* data)
 {
 	EX6_ImageButton* data_imagebutton = (EX6_ImageButton*)data;
+
+	ex6_ui_mark_dirty();
 	//char* buf;
 	//
 	//TTF_SetTextString
 	//ImGui::InputTextMultiline("text", buf, 1024);
 	ImGui::LabelText("hover callback", "%p", data_imagebutton->fn_callback_hover);
-	ImGui::LabelText("click callback", "%p", data_imagebutton->fn_callback_click);
 
 	int wrap_width;
 	TTF_GetTextWrapWidth(data_imagebutton->ttf_text, &wrap_width);
@@ -337,6 +426,12 @@ struct GameState
 	// // SDL-allocated structures
 	// SDL_Texture* atlas_space;
 	// SDL_Texture* ui_healtbar;
+
+	// atlas sprite handles
+	ITU_IdSprite sprite_player;
+	ITU_IdSprite sprite_asteroid;
+	ITU_IdSprite sprite_healthbar;
+	ITU_IdSprite sprite_button;
 };
 
 void ex6_system_assign_player_target(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
@@ -402,6 +497,25 @@ void ex6_system_player_update(SDLContext* context, ITU_EntityId* entity_ids, int
 	}
 }
 
+// bumping into asteroids hurts
+void ex6_system_contacts_damage(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
+{
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		ITU_EntityId id = entity_ids[i];
+		Contacts*   contacts = entity_get_data(id, Contacts);
+		EX6_Health* health   = entity_get_data(id, EX6_Health);
+
+		int contacts_count = itu_sys_physics_contacts_count(contacts);
+		for(int j = 0; j < contacts_count; ++j)
+		{
+			PhysicsContact* contact = itu_sys_physics_contacts_get(contacts, j);
+			if(contact->type == PHYSICS_CONTACT_BEGIN && itu_entity_is_valid(contact->other) && itu_entity_tag_has(contact->other, TAG_ASTEROID))
+				health->curr = SDL_clamp(health->curr - health->max / 20, 0, health->max);
+		}
+	}
+}
+
 void ex6_system_health(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
 {
 	for(int i = 0; i < entity_ids_count; ++i)
@@ -412,21 +526,54 @@ void ex6_system_health(SDLContext* context, ITU_EntityId* entity_ids, int entity
 		if(!itu_entity_is_valid(renderer->target))
 			continue;
 
+		EX6_TransformScreen* transform = entity_get_data(id, EX6_TransformScreen);
 		EX6_Sprite9Patch* sprite = entity_get_data(id, EX6_Sprite9Patch);
 		EX6_Health* health = entity_get_data(renderer->target, EX6_Health);
 
 		if(context->btn_isjustpressed[BTN_TYPE_SPACE])
 			health->curr = SDL_clamp(health->curr - health->max / 10, 0, 100);
 
+		float size_prev = sprite->size.x;
 		sprite->size.x = renderer->widget_base_w * (health->curr / health->max);
+		if(sprite->size.x != size_prev)
+			ex6_ui_mark_dirty();
+
+		// label goes through the glyph atlas, it doesn't need a `TTF_Text` for each value
+		if(renderer->label_font && itu_lib_render_queue_layer_needs_redraw(EX6_LAYER_UI_TEXT))
+		{
+			char label[32];
+			SDL_snprintf(label, sizeof(label), "%.0f / %.0f", health->curr, health->max);
+
+			vec2f label_pos;
+			label_pos.x = transform->position.x + renderer->widget_base_w + 12;
+			label_pos.y = transform->position.y + sprite->size.y / 2;
+			itu_lib_text_queue(context, renderer->label_font, renderer->label_size, label, label_pos, vec2f{ 0.0f, 0.5f }, COLOR_WHITE, EX6_LAYER_UI_TEXT);
+		}
 	}
 }
 
 static void game_init(SDLContext* context, GameState* state)
 {
-	itu_sys_rstorage_texture_load(context, "data/kenney/simpleSpace_tilesheet_2.png", SDL_SCALEMODE_LINEAR);
-	itu_sys_rstorage_texture_load(context, "data/kenney/UI/bar_round_gloss_small_red.png", SDL_SCALEMODE_LINEAR);
-	itu_sys_rstorage_texture_load(context, "data/kenney/UI/panel_square.png", SDL_SCALEMODE_LINEAR);
+	// everything goes in the same atlas, so that world and UI sprites can be batched together
+	// sprite rects come from the tilesheet description (parsed once, then cached next to it)
+	ITU_SpriteTable* table_tilesheets = itu_lib_spritetable_load_tilesheets("data/kenney/_tilesheets.txt");
+	SDL_Rect rects_space[2] = { 0 };
+	const char* path_space = NULL;
+	if(table_tilesheets)
+	{
+		itu_lib_spritetable_get(table_tilesheets, "simpleSpace_tilesheet_2_8",  &path_space, &rects_space[0]); // player
+		itu_lib_spritetable_get(table_tilesheets, "simpleSpace_tilesheet_2_32", &path_space, &rects_space[1]); // asteroid
+	}
+	ITU_IdSprite ids_space[array_size(rects_space)] = { 0 };
+	if(path_space)
+		itu_sys_rstorage_atlas_add_subimages(path_space, rects_space, array_size(rects_space), ids_space);
+	itu_lib_spritetable_free(table_tilesheets);
+	state->sprite_player    = ids_space[0];
+	state->sprite_asteroid  = ids_space[1];
+	state->sprite_healthbar = itu_sys_rstorage_atlas_add_image("data/kenney/UI/bar_round_gloss_small_red.png");
+	state->sprite_button    = itu_sys_rstorage_atlas_add_image("data/kenney/UI/panel_square.png");
+	itu_sys_rstorage_atlas_build(context, SDL_SCALEMODE_LINEAR);
+
 	itu_sys_rstorage_font_load(context, "data/ARIAL.TTF", 42);
 	itu_sys_rstorage_font_load(context, "data/ARIALI.TTF", 42);
 	itu_sys_rstorage_font_load(context, "data/ARIALBD.TTF", 42);
@@ -443,6 +590,8 @@ static void game_init(SDLContext* context, GameState* state)
 	enable_component(EX6_Sprite9Patch);
 	enable_component(EX6_ImageButton);
 
+	enable_event(EX6_EventButtonClicked);
+
 	add_component_debug_ui_render(EX6_PlayerData, ex6_debug_ui_render_playerdata);
 	add_component_debug_ui_render(EX6_Health, ex6_debug_ui_render_health);
 	add_component_debug_ui_render(EX6_HealthRenderer, ex6_debug_ui_render_healthrenderer);
@@ -455,23 +604,35 @@ static void game_init(SDLContext* context, GameState* state)
 	
 	add_system(ex6_system_assign_player_target      , component_mask(Transform), tag_mask(TAG_ASTEROID));
 	add_system(ex6_system_player_update             , component_mask(Transform) | component_mask(PhysicsData) | component_mask(EX6_PlayerData)  , 0);
-	add_system(ex6_system_health                    , component_mask(EX6_HealthRenderer)  | component_mask(EX6_Sprite9Patch), 0);
+	add_system(ex6_system_contacts_damage           , component_mask(Contacts) | component_mask(EX6_Health), 0);
+	// NOTE: widgets that can change their look need to run before the UI is pushed to the render queue (see `ex6_ui_mark_dirty()`)
+	add_system(ex6_system_health                    , component_mask(EX6_TransformScreen) | component_mask(EX6_HealthRenderer)  | component_mask(EX6_Sprite9Patch), 0);
+	add_system(ex6_system_imagebutton               , component_mask(EX6_TransformScreen) | component_mask(EX6_Sprite9Patch) | component_mask(EX6_ImageButton) , 0);
 	add_system(ex6_system_sprite_render_camera      , component_mask(EX6_TransformScreen) | component_mask(Sprite)          , 0);
 	add_system(ex6_system_sprite9patch_render_camera, component_mask(EX6_TransformScreen) | component_mask(EX6_Sprite9Patch), 0);
-	add_system(ex6_system_imagebutton               , component_mask(EX6_TransformScreen) | component_mask(EX6_Sprite9Patch) | component_mask(EX6_ImageButton) , 0);
 	add_system(ex6_system_camera_target             , component_mask(Transform), tag_mask(TAG_CAMERA_TARGET));
+
+	add_event_system(ex6_system_button_clicked, EX6_EventButtonClicked);
+
+	// UI changes rarely, so it's rendered to a texture only when needed
+	itu_lib_render_queue_set_layer_cached(EX6_LAYER_UI, true);
+	itu_lib_render_queue_set_layer_cached(EX6_LAYER_UI_TEXT, true);
 }
 
 void TMP_btn_callback_hover(SDLContext* context, ITU_EntityId id) { SDL_Log(""); }
-void TMP_btn_callback_click(SDLContext* context, ITU_EntityId id) { SDL_Log("click"); }
 
 static void game_reset(SDLContext* context, GameState* state)
 {
 	// TMP get textures pointers
 	//     these should come from a serialized file
-	SDL_Texture* tex_space     = itu_sys_rstorage_texture_get_ptr(0);
-	SDL_Texture* tex_healthbar = itu_sys_rstorage_texture_get_ptr(1);
-	SDL_Texture* tex_button    = itu_sys_rstorage_texture_get_ptr(2);
+	SDL_Texture* tex_player;    SDL_FRect rect_player;
+	SDL_Texture* tex_asteroid;  SDL_FRect rect_asteroid;
+	SDL_Texture* tex_healthbar; SDL_FRect rect_healthbar;
+	SDL_Texture* tex_button;    SDL_FRect rect_button;
+	itu_sys_rstorage_sprite_get(state->sprite_player,    &tex_player,    &rect_player);
+	itu_sys_rstorage_sprite_get(state->sprite_asteroid,  &tex_asteroid,  &rect_asteroid);
+	itu_sys_rstorage_sprite_get(state->sprite_healthbar, &tex_healthbar, &rect_healthbar);
+	itu_sys_rstorage_sprite_get(state->sprite_button,    &tex_button,    &rect_button);
 	TTF_Font*    font_bold     = itu_sys_rstorage_font_get_ptr(2);
 
 	itu_sys_estorage_clear_all_entities();
@@ -495,16 +656,18 @@ static void game_reset(SDLContext* context, GameState* state)
 		transform.position.y = -7;
 
 		Sprite sprite;
-		itu_lib_sprite_init(&sprite, tex_space, itu_lib_sprite_get_rect(0, 1, 128, 128));
+		itu_lib_sprite_init(&sprite, tex_player, rect_player);
+		sprite.layer = EX6_LAYER_PLAYER;
 
 		EX6_PlayerData data = { 0 };
 
 		// FIXME this is thrash
 		PhysicsData physics_data = { 0 };
 		physics_data.ignore_rotation = true;
+		physics_data.extrapolate = true; // camera follows the player, so we want as little lag as possible
 		body_def.position = value_cast(b2Vec2, transform.position);
 		body_def.type = b2_dynamicBody;
-		physics_data.body_id = itu_sys_physics_add_body(value_cast(void*, id_player), &body_def);
+		physics_data.body_id = itu_sys_physics_add_body(id_player, &body_def);
 		
 		ShapeData shape_data;
 		shape_data.shape_id = b2CreateCircleShape(physics_data.body_id, &shape_def, &circle);
@@ -514,6 +677,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		health.max = 100;
 		health.curr = 100;
 
+		Contacts contacts = { 0 };
 
 		entity_add_component(id_player, Transform     , transform);
 		entity_add_component(id_player, Sprite        , sprite);
@@ -521,42 +685,47 @@ static void game_reset(SDLContext* context, GameState* state)
 		entity_add_component(id_player, PhysicsData   , physics_data);
 		entity_add_component(id_player, ShapeData     , shape_data);
 		entity_add_component(id_player, EX6_Health    , health);
+		entity_add_component(id_player, Contacts      , contacts);
 		itu_entity_tag_add(id_player, TAG_CAMERA_TARGET);
 	}
 
 	// entities
-	for(int i = 0; i < ENTITY_COUNT; ++i)
 	{
-		ITU_EntityId id = itu_entity_create();
-		char name_buf[16];
-		SDL_snprintf(name_buf, 16, "asteroid_%d", i);
-		itu_entity_set_debug_name(id, name_buf);
-
-		Transform transform = { 0 };
+		Transform transform = TRANSFORM_DEFAULT;
 		Sprite sprite;
-
-		transform.scale = VEC2F_ONE;
-		transform.position.x = SDL_randf() * 16 - 8;
-		transform.position.y = SDL_randf() * 16 - 8;
-
-		itu_lib_sprite_init(&sprite, tex_space, itu_lib_sprite_get_rect(0, 4, 128, 128));
-
-		// FIXME this is thrash
+		itu_lib_sprite_init(&sprite, tex_asteroid, rect_asteroid);
 		PhysicsStaticData physics_data = { 0 };
-		body_def.position = value_cast(b2Vec2, transform.position);
-		body_def.type = b2_staticBody;
-		physics_data.body_id = itu_sys_physics_add_body(value_cast(void*, id), &body_def);
-
-		
-		ShapeData shape_data;
-		shape_data.shape_id = b2CreateCircleShape(physics_data.body_id, &shape_def, &circle);
+		ShapeData shape_data = { 0 };
 
-		entity_add_component(id, Transform,   transform);
-		entity_add_component(id, Sprite,      sprite);
-		entity_add_component(id, PhysicsStaticData, physics_data);
-		entity_add_component(id, ShapeData, shape_data);
-		itu_entity_tag_add(id, TAG_ASTEROID);
+		body_def.type = b2_staticBody;
+		ITU_PhysicsShape shape;
+		shape.type = b2_circleShape;
+		shape.circle = circle;
+
+		ITU_Prefab* prefab_asteroid = itu_prefab_create();
+		prefab_add_component(prefab_asteroid, Transform, transform);
+		prefab_add_component(prefab_asteroid, Sprite, sprite);
+		prefab_add_component(prefab_asteroid, PhysicsStaticData, physics_data);
+		prefab_add_component(prefab_asteroid, ShapeData, shape_data);
+		itu_prefab_tag_add(prefab_asteroid, TAG_ASTEROID);
+		itu_prefab_set_body(prefab_asteroid, &body_def, &shape_def, &shape);
+
+		vec2f positions[ENTITY_COUNT];
+		ITU_EntityId ids[ENTITY_COUNT];
+		for(int i = 0; i < ENTITY_COUNT; ++i)
+		{
+			positions[i].x = SDL_randf() * 16 - 8;
+			positions[i].y = SDL_randf() * 16 - 8;
+		}
+		itu_prefab_instantiate(prefab_asteroid, ENTITY_COUNT, positions, ids);
+		itu_prefab_destroy(prefab_asteroid);
 
+		for(int i = 0; i < ENTITY_COUNT; ++i)
+		{
+			char name_buf[16];
+			SDL_snprintf(name_buf, 16, "asteroid_%d", i);
+			itu_entity_set_debug_name(ids[i], name_buf);
+		}
 	}
 
 	// healtbar
@@ -568,7 +737,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		transform.position = { 20, 18 };
 
 		EX6_Sprite9Patch   sprite;
-		sprite.rect = { 0, 0, 96, 16 };
+		sprite.rect = rect_healthbar;
 		sprite.texture = tex_healthbar;
 		sprite.size = { 760, 16 };
 		sprite.margins_hor = { 8, 8 };
@@ -580,6 +749,8 @@ static void game_reset(SDLContext* context, GameState* state)
 		EX6_HealthRenderer renderer;
 		renderer.target = id_player;
 		renderer.widget_base_w = sprite.size.x;
+		renderer.label_font = font_bold;
+		renderer.label_size = 16;
 
 		entity_add_component(id, EX6_TransformScreen, transform);
 		entity_add_component(id, EX6_Sprite9Patch, sprite);
@@ -595,7 +766,7 @@ static void game_reset(SDLContext* context, GameState* state)
 		transform.position = { 20, context->window_h - 18 };
 
 		EX6_Sprite9Patch sprite;
-		sprite.rect = { 0, 0, 64, 64 };
+		sprite.rect = rect_button;
 		sprite.texture = tex_button;
 		sprite.size = { 280, 48 };
 		sprite.margins_hor = { 8, 8 };
@@ -606,7 +777,6 @@ static void game_reset(SDLContext* context, GameState* state)
 
 		const char btn_text[] = "I am a button!";
 		EX6_ImageButton imagebutton = { 0 };
-		imagebutton.fn_callback_click = TMP_btn_callback_click;
 		imagebutton.ttf_text = TTF_CreateText(ttf_engine, font_bold, btn_text, SDL_strlen(btn_text));
 
 		entity_add_component(id, EX6_TransformScreen, transform);
@@ -615,21 +785,35 @@ static void game_reset(SDLContext* context, GameState* state)
 	}
 }
 
-int main(void)
+// usage: ES06_ui [--headless [frame_count]]
+// headless mode runs a fixed number of frames as fast as possible with the software renderer and no window,
+// then prints timing statistics (used to benchmark rendering)
+int main(int argc, char** argv)
 {
 	bool quit = false;
 	SDLContext context = { 0 };
 	GameState  state   = { };
 
+	bool headless = false;
+	int headless_frames = 600;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(SDL_strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+			if(i + 1 < argc && SDL_isdigit(argv[i + 1][0]))
+				headless_frames = SDL_atoi(argv[++i]);
+		}
+	}
+
 	context.window_w = WINDOW_W;
 	context.window_h = WINDOW_H;
 
 	TTF_Init();
 
 	context.working_dir = SDL_GetCurrentDirectory();
-	context.window = SDL_CreateWindow("ES06 - UI", WINDOW_W, WINDOW_H, 0);
-	context.renderer = SDL_CreateRenderer(context.window, "vulkan");
-	SDL_SetRenderDrawBlendMode(context.renderer, SDL_BLENDMODE_BLEND);
+	if(!sdl_context_create_window(&context, "ES06 - UI", WINDOW_W, WINDOW_H, headless ? NULL : "vulkan", headless))
+		return 1;
 	
 	// increase the zoom to make debug text more legible
 	// (ie, on the class projector, we will usually use 2)
@@ -664,6 +848,12 @@ int main(void)
 	SDL_GetCurrentTime(&walltime_frame_beg);
 	walltime_frame_end = walltime_frame_beg;
 
+	// headless benchmark statistics
+	int frames_count = 0;
+	SDL_Time elapsed_work_tot = 0;
+	SDL_Time elapsed_work_min = SECONDS(1000);
+	SDL_Time elapsed_work_max = 0;
+
 	sdl_input_set_mapping_keyboard(&context, SDLK_W,     BTN_TYPE_UP);
 	sdl_input_set_mapping_keyboard(&context, SDLK_A,     BTN_TYPE_LEFT);
 	sdl_input_set_mapping_keyboard(&context, SDLK_S,     BTN_TYPE_DOWN);
@@ -702,6 +892,49 @@ int main(void)
 						ImGui::LabelText("tot",  "%6.3f ms/f", (float)elapsed_frame / (float)MILLIS(1));
 						ImGui::LabelText("physics steps",  "%d", context.physics_steps_count);
 
+						b2Profile physics_profile = itu_sys_physics_get_profile();
+						ImGui::Text("Physics (last step)");
+						ImGui::LabelText("workers", "%d", itu_sys_physics_get_workers_count());
+						ImGui::LabelText("step",    "%6.3f ms", physics_profile.step);
+						ImGui::LabelText("collide", "%6.3f ms", physics_profile.collide);
+						ImGui::LabelText("solve",   "%6.3f ms", physics_profile.solve);
+
+						PhysicsBudgetStats physics_budget = itu_sys_physics_get_budget_stats();
+						ImGui::LabelText("step cost (avg)", "%6.3f ms", physics_budget.step_cost_ms);
+						ImGui::LabelText("substeps",        "%d", physics_budget.substeps_count);
+						ImGui::LabelText("steps allowed",   "%d", physics_budget.steps_allowed);
+						ImGui::LabelText("dropped (frame)", "%6.3f ms", NS_TO_MILLIS(physics_budget.dropped_frame));
+						ImGui::LabelText("dropped (total)", "%6.3f ms", NS_TO_MILLIS(physics_budget.dropped_total));
+
+						ImGui::Text("Culling");
+						ImGui::LabelText("sprites drawn",  "%d", context.sprites_drawn_count);
+						ImGui::LabelText("sprites culled", "%d", context.sprites_culled_count);
+
+						ITU_RenderQueueStats render_queue_stats = itu_lib_render_queue_get_stats();
+						ImGui::Text("Render queue");
+						ImGui::LabelText("items",      "%d", render_queue_stats.items_count);
+						ImGui::LabelText("draw calls", "%d", render_queue_stats.draw_calls);
+						ImGui::LabelText("cached layers redrawn", "%d", render_queue_stats.cached_layers_redrawn);
+
+						ITU_TextStats text_stats = itu_lib_text_get_stats();
+						ImGui::Text("Text");
+						ImGui::LabelText("faces",              "%d", text_stats.faces_count);
+						ImGui::LabelText("glyphs",             "%d", text_stats.glyphs_count);
+						ImGui::LabelText("runs cached",        "%d", text_stats.runs_count);
+						ImGui::LabelText("runs built (frame)", "%d", text_stats.runs_built);
+
+						ITU_RenderDebugStats render_debug_stats = itu_lib_render_debug_get_stats();
+						ImGui::Text("Debug draw");
+						ImGui::LabelText("shapes",     "%d", render_debug_stats.shapes_count);
+						ImGui::LabelText("draw calls", "%d", render_debug_stats.draw_calls);
+						for(int i = 0; i < ITU_RENDER_DEBUG_LAYER_COUNT; ++i)
+						{
+							const char* names[ITU_RENDER_DEBUG_LAYER_COUNT] = { "layer default", "layer top" };
+							bool enabled = itu_lib_render_debug_get_layer_enabled((ITU_RenderDebugLayer)i);
+							if(ImGui::Checkbox(names[i], &enabled))
+								itu_lib_render_debug_set_layer_enabled((ITU_RenderDebugLayer)i, enabled);
+						}
+
 						ImGui::EndTabItem();
 					}
 					if(ImGui::BeginTabItem("Entities"))
@@ -727,18 +960,46 @@ int main(void)
 		SDL_GetCurrentTime(&walltime_work_end);
 		elapsed_work = walltime_work_end - walltime_frame_beg;
 
-		if(elapsed_work < TARGET_FRAMERATE_NS)
+		if(!headless && elapsed_work < TARGET_FRAMERATE_NS)
 			SDL_DelayNS(TARGET_FRAMERATE_NS - elapsed_work);
 
 		SDL_GetCurrentTime(&walltime_frame_end);
 		elapsed_frame = walltime_frame_end - walltime_frame_beg;
 
 		// render
-		SDL_RenderPresent(context.renderer);
+		sdl_context_present(&context);
+
+		if(headless)
+		{
+			// NOTE: work time includes the flush, since that's where the software renderer actually draws everything
+			SDL_GetCurrentTime(&walltime_frame_end);
+			elapsed_work = walltime_frame_end - walltime_frame_beg;
+			elapsed_work_tot += elapsed_work;
+			elapsed_work_min = SDL_min(elapsed_work_min, elapsed_work);
+			elapsed_work_max = SDL_max(elapsed_work_max, elapsed_work);
+			frames_count++;
+			if(frames_count >= headless_frames)
+				quit = true;
+
+			// simulate at the target framerate regardless of how long frames take, so that runs are reproducible
+			elapsed_frame = TARGET_FRAMERATE_NS;
+		}
 
 		context.delta = (float)elapsed_frame / (float)SECONDS(1);
 		context.uptime += context.delta;
 		context.elapsed_frame = elapsed_frame;
 		walltime_frame_beg = walltime_frame_end;
 	}
+
+	if(headless && frames_count > 0)
+	{
+		ITU_RenderQueueStats render_queue_stats = itu_lib_render_queue_get_stats();
+		ITU_RenderDebugStats render_debug_stats = itu_lib_render_debug_get_stats();
+		SDL_Log("headless benchmark: %d frames (%s)\n", frames_count, SDL_GetRendererName(context.renderer));
+		SDL_Log("  work avg %6.3f ms/f\n", (float)elapsed_work_tot / frames_count / (float)MILLIS(1));
+		SDL_Log("  work min %6.3f ms/f\n", (float)elapsed_work_min / (float)MILLIS(1));
+		SDL_Log("  work max %6.3f ms/f\n", (float)elapsed_work_max / (float)MILLIS(1));
+		SDL_Log("  render queue %d items, %d draw calls (last frame)\n", render_queue_stats.items_count, render_queue_stats.draw_calls);
+		SDL_Log("  debug draw   %d shapes, %d draw calls (last frame)\n", render_debug_stats.shapes_count, render_debug_stats.draw_calls);
+	}
 }
@@ -68,6 +68,46 @@
 #define FLOAT_MIN_VAL -2e64; // arbitrary floating point min value. Techically we can hold bigger numbers (https://en.wikipedia.org/wiki/Single-precision_floating-point_format), but precision will be abismal. For games, this should be more than enough
 
 
+// *******************************************************************
+// SIMD
+// the best instruction set available at compile time is exposed as one of
+// - ITU_SIMD_AVX2 (needs `-mavx2` or `/arch:AVX2`)
+// - ITU_SIMD_SSE2 (always available on x64)
+// - ITU_SIMD_NEON (AArch64 only, we need 64bit lane comparisons)
+// define ITU_SIMD_DISABLE to force the scalar code paths (useful to check SIMD code against them)
+// *******************************************************************
+
+#ifndef ITU_SIMD_DISABLE
+#if defined(__AVX2__)
+#define ITU_SIMD_AVX2
+#define ITU_SIMD_SSE2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define ITU_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ITU_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif // ITU_SIMD_DISABLE
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// returns the index of the lowest set bit of `x`
+// NOTE: `x` must not be 0
+inline int bit_ctz32(Uint32 x)
+{
+#ifdef _MSC_VER
+	unsigned long ret;
+	_BitScanForward(&ret, x);
+	return (int)ret;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
 // *******************************************************************
 // data structures
 // NOTE: this is the C++ version, so operator overloading party
@@ -1,68 +1,158 @@
 void itu_system_sprite_render(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
 {
+	// NOTE: sprites are sorted and batched by the render queue, which is flushed after all systems are run
+
+	// culling: gather a conservative world-space AABB for every sprite (SoA), and test all of them
+	//          against the camera rect in a single batch
+	ITU_Arena* arena = itu_lib_arena_frame();
+	float* aabbs_min_x = arena_push_array(arena, float, entity_ids_count);
+	float* aabbs_min_y = arena_push_array(arena, float, entity_ids_count);
+	float* aabbs_max_x = arena_push_array(arena, float, entity_ids_count);
+	float* aabbs_max_y = arena_push_array(arena, float, entity_ids_count);
+	int*   visible     = arena_push_array(arena, int,   entity_ids_count);
+	if(!aabbs_min_x || !aabbs_min_y || !aabbs_max_x || !aabbs_max_y || !visible)
+	{
+		// out of scratch memory, just draw everything
+		for(int i = 0; i < entity_ids_count; ++i)
+			itu_lib_sprite_queue(context, entity_get_data(entity_ids[i], Sprite), entity_get_data(entity_ids[i], Transform));
+		context->sprites_drawn_count = entity_ids_count;
+		context->sprites_culled_count = 0;
+		return;
+	}
+
 	for(int i = 0; i < entity_ids_count; ++i)
 	{
 		ITU_EntityId id = entity_ids[i];
 		Transform* transform = entity_get_data(id, Transform);
 		Sprite*    sprite = entity_get_data(id, Sprite);
 
-		itu_lib_sprite_render(context, sprite, transform);
+		// the sprite can rotate around its pivot, so we use the farthest corner from it as radius
+		vec2f size = itu_lib_sprite_get_world_size(context, sprite, transform);
+		float extent_x = SDL_fabsf(transform->scale.x) * size.x * SDL_max(sprite->pivot.x, 1 - sprite->pivot.x);
+		float extent_y = SDL_fabsf(transform->scale.y) * size.y * SDL_max(sprite->pivot.y, 1 - sprite->pivot.y);
+		float radius = SDL_sqrtf(extent_x * extent_x + extent_y * extent_y);
+
+		aabbs_min_x[i] = transform->position.x - radius;
+		aabbs_min_y[i] = transform->position.y - radius;
+		aabbs_max_x[i] = transform->position.x + radius;
+		aabbs_max_y[i] = transform->position.y + radius;
+	}
+
+	SDL_FRect view = camera_get_world_rect(context, context->camera_active);
+	int visible_count = itu_lib_overlaps_rects_rect(
+		aabbs_min_x, aabbs_min_y, aabbs_max_x, aabbs_max_y, entity_ids_count,
+		vec2f{ view.x, view.y }, vec2f{ view.x + view.w, view.y + view.h },
+		visible
+	);
+
+	for(int i = 0; i < visible_count; ++i)
+	{
+		ITU_EntityId id = entity_ids[visible[i]];
+		Transform* transform = entity_get_data(id, Transform);
+		Sprite*    sprite = entity_get_data(id, Sprite);
+
+		itu_lib_sprite_queue(context, sprite, transform);
 	}
+
+	context->sprites_drawn_count = visible_count;
+	context->sprites_culled_count = entity_ids_count - visible_count;
 }
 
+void itu_system_tilemap_render(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
+{
+	// NOTE: culling is done per-chunk by the tilemap itself
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		ITU_EntityId id = entity_ids[i];
+		itu_lib_tilemap_queue(context, entity_get_data(id, Tilemap), entity_get_data(id, Transform));
+	}
+}
+
+// physics -> ECS sync is driven by box2d move events, so sleeping bodies cost nothing
+// (only bodies that haven't settled yet get their `Transform` and `PhysicsData` written, once per frame,
+// including frames where no step runs)
 void itu_system_physics(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
 {
+	// velocities set by game logic (anything different from what we wrote last time)
 	for(int i = 0; i < entity_ids_count; ++i)
 	{
 		ITU_EntityId id = entity_ids[i];
 		PhysicsData* physics_data = entity_get_data(id, PhysicsData);
 
-		b2Body_SetLinearVelocity(physics_data->body_id, value_cast(b2Vec2, physics_data->velocity));
-		b2Body_SetAngularVelocity(physics_data->body_id, physics_data->torque);
+		if(physics_data->velocity.x != physics_data->synced_velocity.x || physics_data->velocity.y != physics_data->synced_velocity.y)
+		{
+			b2Body_SetLinearVelocity(physics_data->body_id, value_cast(b2Vec2, physics_data->velocity));
+			physics_data->synced_velocity = physics_data->velocity;
+		}
+		if(physics_data->torque != physics_data->synced_torque)
+		{
+			b2Body_SetAngularVelocity(physics_data->body_id, physics_data->torque);
+			physics_data->synced_torque = physics_data->torque;
+		}
 	}
 
 	context->physics_steps_count = 0;
 	context->accumulator_physics += context->elapsed_frame;
 
 	// decouple physics step from framerate, running 0, 1 or multiple physics step per frame
-	while(context->accumulator_physics >= PHYSICS_TIMESTEP_NSECS && context->physics_steps_count < PHYSICS_MAX_TIMESTEPS_PER_FRAME)
+	// (as many as the physics budget allows)
+	// NOTE: poses are only recorded here, they are blended once after all steps are done
+	int steps_allowed = itu_sys_physics_budget_get_steps_allowed(PHYSICS_MAX_TIMESTEPS_PER_FRAME);
+	itu_sys_physics_poses_frame_begin();
+	while(context->accumulator_physics >= PHYSICS_TIMESTEP_NSECS && context->physics_steps_count < steps_allowed)
 	{
 		itu_sys_physics_step(PHYSICS_TIMESTEP_SECS);
 		context->physics_steps_count++;
 		context->accumulator_physics -= PHYSICS_TIMESTEP_NSECS;
 
-		// update game state from b2d state, interpolating when physics step is out of synch with game logic
-		// NOTE: we need to read the b2d state every step in order to get a correct interpolation, even if it's wasteful
-		//       (there is definitely a way to adjust `t` and `t_inv` based on the numbers of steps done and do the reading only once,
-		//       marking it as a TODO for the future)
-		float t = (float)(context->accumulator_physics) / (float)PHYSICS_TIMESTEP_NSECS;
-		float t_inv = 1 - t;
+		itu_sys_physics_poses_read_step();
+		itu_sys_physics_contacts_read_step();
+	}
 
-		for(int i = 0; i < entity_ids_count; ++i)
-		{
-			ITU_EntityId id = entity_ids[i];
-			Transform*  transform = entity_get_data(id, Transform);
-			PhysicsData* physics_data = entity_get_data(id, PhysicsData);
+	// whatever we couldn't step is dropped (simulation slows down) instead of piling up for next frames,
+	// which would only make them slower and slower
+	SDL_Time dropped = 0;
+	if(context->accumulator_physics >= PHYSICS_TIMESTEP_NSECS)
+	{
+		dropped = context->accumulator_physics - context->accumulator_physics % PHYSICS_TIMESTEP_NSECS;
+		context->accumulator_physics -= dropped;
+	}
+	itu_sys_physics_budget_frame_end(dropped);
+
+	// update game state from b2d state, interpolating when physics step is out of synch with game logic
+	float alpha = (float)(context->accumulator_physics) / (float)PHYSICS_TIMESTEP_NSECS;
+	float extrapolation_dt = NS_TO_SECONDS(context->accumulator_physics);
 
-			b2Vec2 physics_vel = b2Body_GetLinearVelocity(physics_data->body_id);
-			float  physics_trq = b2Body_GetAngularVelocity(physics_data->body_id);
-			b2Vec2 physics_pos = b2Body_GetPosition(physics_data->body_id);
-			b2Rot  physics_rot = b2Body_GetRotation(physics_data->body_id);
+	ITU_EntityId* active;
+	int active_count = itu_sys_physics_poses_get_active(&active);
+	for(int i = 0; i < active_count; ++i)
+	{
+		ITU_EntityId id = active[i];
 
-			physics_data->velocity = value_cast(vec2f, physics_vel) * t + physics_data->fixed_step_velocity * t_inv;
-			physics_data->torque   = physics_trq * t + physics_data->fixed_step_torque * t_inv;
+		// bodies owned by other components (ie, kinematic `PhysicsStaticData`), or without a `Transform` to write to
+		PhysicsData* physics_data = entity_get_data(id, PhysicsData);
+		Transform* transform = entity_get_data(id, Transform);
+		if(!physics_data || !transform)
+			continue;
 
+		// velocities are read back once per frame (from the last step, if any)
+		b2Vec2 physics_vel = b2Body_GetLinearVelocity(physics_data->body_id);
+		physics_data->velocity = value_cast(vec2f, physics_vel);
+		physics_data->torque   = b2Body_GetAngularVelocity(physics_data->body_id);
+		physics_data->synced_velocity = physics_data->velocity;
+		physics_data->synced_torque   = physics_data->torque;
 
-			if(!physics_data->ignore_position)
-				transform->position = value_cast(vec2f, physics_pos) * t + physics_data->fixed_step_position * t_inv;
+		vec2f position;
+		float rotation;
+		if(physics_data->extrapolate)
+			itu_sys_physics_poses_extrapolate(id, extrapolation_dt, physics_data->velocity, physics_data->torque, &position, &rotation);
+		else
+			itu_sys_physics_poses_blend(id, alpha, &position, &rotation);
 
-			if(!physics_data->ignore_rotation)
-				transform->rotation = b2Rot_GetAngle(physics_rot) * t + physics_data->fixed_step_rotation * t_inv;
+		if(!physics_data->ignore_position)
+			transform->position = position;
 
-			physics_data->fixed_step_velocity = value_cast(vec2f, physics_vel);
-			physics_data->fixed_step_torque = physics_trq;
-			physics_data->fixed_step_position = value_cast(vec2f, physics_pos);
-			physics_data->fixed_step_rotation = b2Rot_GetAngle(physics_rot);
-		}
+		if(!physics_data->ignore_rotation)
+			transform->rotation = rotation;
 	}
 }
@@ -1,5 +1,7 @@
 ﻿#ifndef ITU_UNITY_BUILD
 #include <itu_entity_storage.hpp>
+#include <itu_lib_render_queue.hpp>
+#include <itu_lib_render.hpp>
 #include <imgui/imgui.h>
 #endif
 
@@ -44,7 +46,40 @@ struct ITU_System
 	ITU_TagType tags[SYSTEM_TAGS_MAX];
 	int tags_count;
 
+	Uint64 component_mask;
+	Uint64 component_mask_exclude;
+	bool   query_used_scan; // strategy picked the last time matching entities were gathered (for debug only)
+
 	ITU_SystemUpdateFunction fn_update;
+
+	// event systems only (`fn_update` is NULL for them)
+	ITU_SystemEventsFunction fn_update_events;
+	ITU_EventType event_type;
+};
+
+// how many entity masks the vectorized scan tests in (roughly) the time of one random pool lookup
+// used by `itu_system_get_matching_entities()` to pick the query strategy
+#ifndef QUERY_SCAN_COST_RATIO
+#define QUERY_SCAN_COST_RATIO 8
+#endif
+
+// minimum number of events allocated the first time a channel is written in a frame
+#define EVENTS_CHANNEL_CAPACITY_MIN 64
+
+struct ITU_EventChannel
+{
+	ITU_EventType type;
+	const char* name;
+	Uint64 element_size;
+
+	// double buffer, indexed with `ITU_EntityStorageContext.events_buffer_curr`:
+	// - the current buffer is written during this frame
+	// - the other one holds the events of last frame, and it's the one systems read
+	// NOTE: buffers are allocated from the frame arenas, and they are swapped together with them,
+	//       so we never need to free them
+	void* buffers[2];
+	int   counts[2];
+	int   capacities[2];
 };
 
 struct ITU_Entity
@@ -66,6 +101,10 @@ struct ITU_EntityStorageContext
 	ITU_System systems[SYSTEMS_COUNT_MAX];
 	int systems_count;
 
+	ITU_EventChannel event_channels[EVENT_TYPES_COUNT_MAX];
+	int event_channels_count;
+	int events_buffer_curr;
+
 	// debug properties
 	stbds_hm(ITU_EntityId, char*) entities_debug_names;
 	stbds_hm(Sint32, const char*) tag_debug_names;
@@ -74,13 +113,17 @@ struct ITU_EntityStorageContext
 static ITU_ComponentType component_type_counter;
 ITU_EntityStorageContext ctx_estorage;
 
+void itu_sys_estorage_events_swap();
+
 ITU_Component* itu_component_pool_create(size_t element_size, Uint64 total_num_component, const char* component_name);
 void  itu_component_pool_assign(ITU_Component* component_pool, ITU_EntityId entity);
+void* itu_component_pool_assign_batch(ITU_Component* component_pool, ITU_EntityId* entities, int count, void* in_data_copy);
 void  itu_component_pool_data_get(ITU_Component* component_pool, ITU_EntityId entity, void* out_data_copy);
 void  itu_component_pool_data_set(ITU_Component* component_pool, ITU_EntityId entity, void* in_data_copy);
 void  itu_component_pool_remove(ITU_Component* component_pool, ITU_EntityId entity);
 void  itu_component_pool_clear(ITU_Component* component_pool);
 int   itu_system_get_matching_entities(ITU_System* system, ITU_EntityId* out_entitiy_group);
+int   itu_entity_mask_scan(Uint64 mask_required, Uint64 mask_excluded, ITU_EntityId* out_ids);
 
 ITU_Component* itu_component_pool_create(Uint64 element_size, Uint64 total_num_component, const char* component_name)
 {
@@ -118,7 +161,8 @@ void itu_sys_estorage_add_component_debug_ui_render(ITU_ComponentType component_
 void itu_sys_estorage_init(int starting_entities_count, bool enable_standard_components=true)
 {
 	// allocate a minimum of elements at initialization time, to minimize early reallocs
-	stbds_arrsetlen(ctx_estorage.entities, starting_entities_count);
+	// NOTE: this must only reserve space, setting the length would leave uninitialized entities (with garbage masks) in the array
+	stbds_arrsetcap(ctx_estorage.entities, starting_entities_count);
 	//stbds_hmset(ctx_estorage.entities_debug_names, starting_entities_count);
 
 	if(enable_standard_components)
@@ -128,14 +172,22 @@ void itu_sys_estorage_init(int starting_entities_count, bool enable_standard_com
 		enable_component(PhysicsData);
 		enable_component(PhysicsStaticData);
 		enable_component(ShapeData);
+		enable_component(Tilemap);
+		enable_component(Collider);
+		// NOTE: few entities care about their contacts, and each component is quite big
+		itu_sys_estorage_add_component_pool(sizeof(Contacts), PHYSICS_CONTACTS_COMPONENTS_MAX, &ITU_COMPONENT_TYPE_Contacts, ITU_COMPONENT_NAME_Contacts);
 
 		add_component_debug_ui_render(ShapeData, itu_debug_ui_render_shapedata);
 		add_component_debug_ui_render(Transform, itu_debug_ui_render_transform);
 		add_component_debug_ui_render(Sprite, itu_debug_ui_render_sprite);
 		add_component_debug_ui_render(PhysicsData, itu_debug_ui_render_physicsdata);
 		add_component_debug_ui_render(PhysicsStaticData, itu_debug_ui_render_physicsstaticdata);
+		add_component_debug_ui_render(Contacts, itu_debug_ui_render_contacts);
+		add_component_debug_ui_render(Collider, itu_debug_ui_render_collider);
 
 		add_system(itu_system_physics       , component_mask(PhysicsData)                                  , 0);
+		add_system(itu_system_collisions    , component_mask(Transform)   | component_mask(Collider)       , 0);
+		add_system(itu_system_tilemap_render, component_mask(Transform)   | component_mask(Tilemap)        , 0);
 		add_system(itu_system_sprite_render , component_mask(Transform)   | component_mask(Sprite)         , 0);
 	}
 }
@@ -186,6 +238,8 @@ void itu_sys_estorage_set_systems(ITU_SystemDef* systems, int systems_count)
 			if(system_def->tag_mask & tag_bitmask)
 				system_runtime->tags[system_runtime->tags_count++] = j;
 		}
+		system_runtime->component_mask = system_def->component_mask;
+		system_runtime->component_mask_exclude = system_def->component_mask_exclude;
 		system_runtime->fn_update = system_def->fn_update;
 		system_runtime->name = system_def->name;
 	}
@@ -214,14 +268,113 @@ void itu_sys_estorage_add_system(ITU_SystemDef system_def)
 		if(system_def.tag_mask & tag_bitmask)
 			system_runtime->tags[system_runtime->tags_count++] = j;
 	}
+	system_runtime->component_mask = system_def.component_mask;
+	system_runtime->component_mask_exclude = system_def.component_mask_exclude;
 	system_runtime->fn_update = system_def.fn_update;
 	system_runtime->name = system_def.name;
 }
 
 
+// scans the whole (packed) entity array, keeping entities where `(mask & required) == required && !(mask & excluded)`
+// matching ids are written in `out_ids` in entity order, returns how many matched
+// NOTE: destroyed entities have an empty mask, so they are skipped as long as `mask_required` is not 0
+int itu_entity_mask_scan(Uint64 mask_required, Uint64 mask_excluded, ITU_EntityId* out_ids)
+{
+	ITU_Entity* entities = ctx_estorage.entities;
+	int entities_count = stbds_arrlen(entities);
+	int ret = 0;
+	int i = 0;
+
+	// all SIMD paths test 4 entities per iteration, and produce a 4 bit `hits` mask (bit k -> entity i+k)
+	// which is then compacted into `out_ids` (emulating a compress-store)
+#if defined(ITU_SIMD_AVX2)
+	__m256i v_required = _mm256_set1_epi64x(mask_required);
+	__m256i v_excluded = _mm256_set1_epi64x(mask_excluded);
+	__m256i v_zero     = _mm256_setzero_si256();
+	for(; i + 4 <= entities_count; i += 4)
+	{
+		__m256i e01 = _mm256_loadu_si256((__m256i*)&entities[i]);
+		__m256i e23 = _mm256_loadu_si256((__m256i*)&entities[i + 2]);
+
+		// unpack works per 128bit lane, so we get [e0, e2, e1, e3] masks, and we need to reorder them
+		__m256i masks = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(e01, e23), 0xD8);
+
+		// (~mask & required) | (mask & excluded) is 0 only for matching entities
+		__m256i fail = _mm256_or_si256(_mm256_andnot_si256(masks, v_required), _mm256_and_si256(masks, v_excluded));
+		Uint32 hits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(fail, v_zero)));
+
+		while(hits)
+		{
+			out_ids[ret++] = entities[i + bit_ctz32(hits)].id;
+			hits &= hits - 1;
+		}
+	}
+#elif defined(ITU_SIMD_SSE2)
+	__m128i v_required = _mm_set1_epi64x(mask_required);
+	__m128i v_excluded = _mm_set1_epi64x(mask_excluded);
+	__m128i v_zero     = _mm_setzero_si128();
+	for(; i + 4 <= entities_count; i += 4)
+	{
+		__m128i masks01 = _mm_unpackhi_epi64(_mm_loadu_si128((__m128i*)&entities[i    ]), _mm_loadu_si128((__m128i*)&entities[i + 1]));
+		__m128i masks23 = _mm_unpackhi_epi64(_mm_loadu_si128((__m128i*)&entities[i + 2]), _mm_loadu_si128((__m128i*)&entities[i + 3]));
+
+		__m128i fail01 = _mm_or_si128(_mm_andnot_si128(masks01, v_required), _mm_and_si128(masks01, v_excluded));
+		__m128i fail23 = _mm_or_si128(_mm_andnot_si128(masks23, v_required), _mm_and_si128(masks23, v_excluded));
+
+		// SSE2 has no 64bit compare: compare 32bit halves, and an entity matches only if both its halves are 0
+		Uint32 halves01 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(fail01, v_zero)));
+		Uint32 halves23 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(fail23, v_zero)));
+		halves01 &= halves01 >> 1;
+		halves23 &= halves23 >> 1;
+		Uint32 hits = (halves01 & 1) | ((halves01 >> 1) & 2) | ((halves23 & 1) << 2) | ((halves23 << 1) & 8);
+
+		while(hits)
+		{
+			out_ids[ret++] = entities[i + bit_ctz32(hits)].id;
+			hits &= hits - 1;
+		}
+	}
+#elif defined(ITU_SIMD_NEON)
+	uint64x2_t v_required = vdupq_n_u64(mask_required);
+	uint64x2_t v_excluded = vdupq_n_u64(mask_excluded);
+	uint64x2_t v_zero     = vdupq_n_u64(0);
+	for(; i + 4 <= entities_count; i += 4)
+	{
+		// de-interleaving loads: val[0] holds the ids, val[1] the masks
+		uint64x2x2_t e01 = vld2q_u64((const uint64_t*)&entities[i]);
+		uint64x2x2_t e23 = vld2q_u64((const uint64_t*)&entities[i + 2]);
+
+		uint64x2_t ok01 = vceqq_u64(vorrq_u64(vbicq_u64(v_required, e01.val[1]), vandq_u64(e01.val[1], v_excluded)), v_zero);
+		uint64x2_t ok23 = vceqq_u64(vorrq_u64(vbicq_u64(v_required, e23.val[1]), vandq_u64(e23.val[1], v_excluded)), v_zero);
+
+		Uint32 hits =
+			((Uint32)vgetq_lane_u64(ok01, 0) & 1)        |
+			((Uint32)vgetq_lane_u64(ok01, 1) & 1) << 1   |
+			((Uint32)vgetq_lane_u64(ok23, 0) & 1) << 2   |
+			((Uint32)vgetq_lane_u64(ok23, 1) & 1) << 3;
+
+		while(hits)
+		{
+			out_ids[ret++] = entities[i + bit_ctz32(hits)].id;
+			hits &= hits - 1;
+		}
+	}
+#endif
+
+	// scalar path (also handles the remainder of the SIMD loops)
+	for(; i < entities_count; ++i)
+	{
+		Uint64 mask = entities[i].component_mask;
+		if((mask & mask_required) == mask_required && !(mask & mask_excluded))
+			out_ids[ret++] = entities[i].id;
+	}
+
+	return ret;
+}
+
 int itu_system_get_matching_entities(ITU_System* system, ITU_EntityId* out_entitiy_group)
 {
-	ITU_EntityId* min_component;
+	ITU_EntityId* min_component = NULL;
 	Uint64  min_component_size = ENTITIES_COUNT_MAX + 1;
 	int system_ids_count = 0;
 
@@ -236,7 +389,10 @@ int itu_system_get_matching_entities(ITU_System* system, ITU_EntityId* out_entit
 	{
 		auto tmp = ctx_estorage.tags[system->tags[j]];
 		if(!tmp)
-			continue;
+		{
+			// no entity has this tag, so nothing can match
+			return 0;
+		}
 		if(stbds_hmlen(tmp) < min_component_size)
 		{
 			min_component = (ITU_EntityId*)tmp;
@@ -244,6 +400,43 @@ int itu_system_get_matching_entities(ITU_System* system, ITU_EntityId* out_entit
 		}
 	}
 
+	if(!min_component)
+		return 0;
+
+	// pick the cheapest strategy, based on pool statistics:
+	// - filtering the smallest pool does `min_component_size` iterations, each with (roughly) one random lookup per component
+	// - the mask scan streams the whole entity array, testing several masks per instruction, and only needs to check tags afterwards
+	// QUERY_SCAN_COST_RATIO is (more or less) how many masks we can test in the time of a single random lookup
+	int entities_count = stbds_arrlen(ctx_estorage.entities);
+	Uint64 lookups_per_entity = system->components_count + (system->component_mask_exclude ? 1 : 0);
+	system->query_used_scan = system->components_count > 0 && min_component_size * lookups_per_entity * QUERY_SCAN_COST_RATIO >= entities_count;
+
+	if(system->query_used_scan)
+	{
+		system_ids_count = itu_entity_mask_scan(system->component_mask, system->component_mask_exclude, out_entitiy_group);
+		if(system->tags_count == 0)
+			return system_ids_count;
+
+		// filter survivors by tag (in place)
+		int count_filtered = 0;
+		for(int k = 0; k < system_ids_count; ++k)
+		{
+			ITU_EntityId entity_curr = out_entitiy_group[k];
+			bool filter_out = false;
+			for(int j = 0; j < system->tags_count; ++j)
+			{
+				if(stbds_hmgeti(ctx_estorage.tags[system->tags[j]], entity_curr) == -1)
+				{
+					filter_out = true;
+					break;
+				}
+			}
+			if(!filter_out)
+				out_entitiy_group[count_filtered++] = entity_curr;
+		}
+		return count_filtered;
+	}
+
 	// filter entities
 	for(int k = 0; k < min_component_size; ++k)
 	{
@@ -260,6 +453,9 @@ int itu_system_get_matching_entities(ITU_System* system, ITU_EntityId* out_entit
 			}
 		}
 
+		if(ctx_estorage.entities[entity_curr.index].component_mask & system->component_mask_exclude)
+			filter_out = true;
+
 		for(int j = 0; j < system->tags_count; ++j)
 		{
 			ITU_TagType filtered_tag = system->tags[j];
@@ -279,14 +475,130 @@ int itu_system_get_matching_entities(ITU_System* system, ITU_EntityId* out_entit
 
 void itu_sys_estorage_systems_update(SDLContext* context)
 {
+	// new frame: last frame's events become readable, and we start collecting this frame's ones
+	itu_lib_arena_frame_begin();
+	itu_sys_estorage_events_swap();
+
+	// debug shapes drawn by systems are accumulated, and drawn on top of everything else at the end
+	itu_lib_render_debug_begin();
+
 	for(int i = 0; i < ctx_estorage.systems_count; ++i)
 	{
 		ITU_System* system = &ctx_estorage.systems[i];
+
+		if(system->fn_update_events)
+		{
+			int events_count;
+			void* events = itu_sys_estorage_events_read(system->event_type, &events_count);
+			if(events_count > 0)
+				system->fn_update_events(context, events, events_count);
+			continue;
+		}
+
 		ITU_EntityId system_ids[ENTITIES_COUNT_MAX];
 		int system_ids_count = itu_system_get_matching_entities(system, system_ids);
 
 		system->fn_update(context, system_ids, system_ids_count);
 	}
+
+	// draw everything systems pushed in the render queue, sorted by layer (and batched by texture)
+	itu_lib_render_queue_flush(context);
+
+	itu_lib_render_debug_end(context->renderer);
+}
+
+// =====================================================================================
+// event channels
+// =====================================================================================
+
+ITU_EventType itu_sys_estorage_add_event_channel(Uint64 element_size, ITU_EventType* ref_event_type, const char* event_name)
+{
+	SDL_assert(ctx_estorage.event_channels_count < EVENT_TYPES_COUNT_MAX);
+
+	ITU_EventType type = ctx_estorage.event_channels_count++;
+	ITU_EventChannel* channel = &ctx_estorage.event_channels[type];
+	*channel = { 0 };
+	channel->type = type;
+	channel->name = event_name;
+	channel->element_size = element_size;
+
+	// make event type globally available
+	*ref_event_type = type;
+
+	return type;
+}
+
+void itu_sys_estorage_add_event_system(const char* name, ITU_SystemEventsFunction fn_update, ITU_EventType event_type)
+{
+	if(ctx_estorage.systems_count == SYSTEMS_COUNT_MAX)
+	{
+		SDL_Log("WARNING maximum number of systes reached");
+		return;
+	}
+
+	ITU_System* system_runtime = &ctx_estorage.systems[ctx_estorage.systems_count++];
+	*system_runtime = { 0 };
+	system_runtime->name = name;
+	system_runtime->fn_update_events = fn_update;
+	system_runtime->event_type = event_type;
+}
+
+void itu_sys_estorage_events_push(ITU_EventType event_type, void* in_data_copy)
+{
+	SDL_assert(event_type < ctx_estorage.event_channels_count);
+
+	ITU_EventChannel* channel = &ctx_estorage.event_channels[event_type];
+	int curr = ctx_estorage.events_buffer_curr;
+
+	if(channel->counts[curr] == channel->capacities[curr])
+	{
+		// grow by allocating a bigger buffer from the frame arena.
+		// The old buffer is just abandoned, it will be reclaimed when the arena is reset
+		int capacity_new = SDL_max(EVENTS_CHANNEL_CAPACITY_MIN, channel->capacities[curr] * 2);
+		void* buffer_new = itu_lib_arena_alloc(itu_lib_arena_frame(), capacity_new * channel->element_size, 16);
+		if(!buffer_new)
+		{
+			SDL_Log("WARNING dropping event of type %s\n", channel->name);
+			return;
+		}
+		if(channel->counts[curr] > 0)
+			SDL_memcpy(buffer_new, channel->buffers[curr], channel->counts[curr] * channel->element_size);
+
+		channel->buffers[curr] = buffer_new;
+		channel->capacities[curr] = capacity_new;
+	}
+
+	void* dst = pointer_index(channel->buffers[curr], channel->counts[curr], channel->element_size);
+	SDL_memcpy(dst, in_data_copy, channel->element_size);
+	channel->counts[curr]++;
+}
+
+// returns last frame's events of the given type (as a contiguous array)
+void* itu_sys_estorage_events_read(ITU_EventType event_type, int* out_count)
+{
+	SDL_assert(event_type < ctx_estorage.event_channels_count);
+
+	ITU_EventChannel* channel = &ctx_estorage.event_channels[event_type];
+	int prev = 1 - ctx_estorage.events_buffer_curr;
+
+	*out_count = channel->counts[prev];
+	return channel->buffers[prev];
+}
+
+// NOTE: must be called right after `itu_lib_arena_frame_begin()`, so that the buffer we start writing to
+//       and the frame arena that we allocate it from are recycled together
+void itu_sys_estorage_events_swap()
+{
+	int curr = 1 - ctx_estorage.events_buffer_curr;
+	ctx_estorage.events_buffer_curr = curr;
+
+	for(int i = 0; i < ctx_estorage.event_channels_count; ++i)
+	{
+		ITU_EventChannel* channel = &ctx_estorage.event_channels[i];
+		channel->buffers[curr] = NULL;
+		channel->counts[curr] = 0;
+		channel->capacities[curr] = 0;
+	}
 }
 
 enum ITU_SysEstorageDebugDetailCategory { ITU_SYS_ESTORAGE_DETAIL_CATEGORY_ENTITY, ITU_SYS_ESTORAGE_DETAIL_CATEGORY_SYSTEM, ITU_SYS_ESTORAGE_DETAIL_CATEGORY_MAX };
@@ -338,9 +650,20 @@ void itu_sys_estorage_debug_render_detail_entity(SDLContext* context, ITU_Entity
 
 void itu_sys_estorage_debug_render_detail_system(SDLContext* context, ITU_System* system, ITU_EntityId* system_ids, int system_ids_count)
 {
+	if(system->fn_update_events)
+	{
+		ImGui::CollapsingHeader("event channel", ImGuiTreeNodeFlags_Leaf);
+		ImGui::Text("%s", ctx_estorage.event_channels[system->event_type].name);
+		return;
+	}
+
 	ImGui::CollapsingHeader("components", ImGuiTreeNodeFlags_Leaf);
 	for(int i = 0; i < system->components_count; ++i)
 		ImGui::Text("%s", system->components[i]->name);
+	for(int i = 0; i < ctx_estorage.components_count; ++i)
+		if(system->component_mask_exclude & (1ull << i))
+			ImGui::Text("NOT %s", ctx_estorage.components[i]->name);
+	ImGui::Text("query: %s", system->query_used_scan ? "mask scan" : "pool filter");
 
 	// TODO wrap tag list rendering in appropriate function
 	{
@@ -497,8 +820,17 @@ void itu_sys_estorage_debug_render(SDLContext* context)
 						system_ids_count = &scratch_system_ids_count;
 					}
 
-					*system_ids_count = itu_system_get_matching_entities(system, system_ids);
-					ImGui::Text("%d", *system_ids_count);
+					if(system->fn_update_events)
+					{
+						// for event systems, show the size of the batch they are handed this frame
+						itu_sys_estorage_events_read(system->event_type, system_ids_count);
+						ImGui::Text("%d ev", *system_ids_count);
+					}
+					else
+					{
+						*system_ids_count = itu_system_get_matching_entities(system, system_ids);
+						ImGui::Text("%d", *system_ids_count);
+					}
 				}
 
 				ImGui::EndTable();
@@ -541,6 +873,43 @@ void itu_component_pool_assign(ITU_Component* component_pool, ITU_EntityId entit
 	SDL_memset((unsigned char*)component_pool->data + component_pool->element_size * i, 0, component_pool->element_size);
 }
 
+// assigns `count` contiguous slots in the pool, filling all of them with the same `in_data_copy` (or zeroes, if NULL)
+// returns a pointer to the first slot, so that the caller can patch per-entity data column-wise
+void* itu_component_pool_assign_batch(ITU_Component* component_pool, ITU_EntityId* entities, int count, void* in_data_copy)
+{
+	SDL_assert(component_pool);
+	SDL_assert(component_pool->count_alive + count <= component_pool->count_max);
+
+	Uint64 loc_first = component_pool->count_alive;
+	component_pool->count_alive += count;
+
+	for(int i = 0; i < count; ++i)
+	{
+		component_pool->data_loc[entities[i].index] = loc_first + i;
+		component_pool->entity_ids[loc_first + i] = entities[i];
+	}
+
+	Uint64 element_size = component_pool->element_size;
+	unsigned char* data = (unsigned char*)pointer_index(component_pool->data, loc_first, element_size);
+	if(!in_data_copy)
+	{
+		SDL_memset(data, 0, element_size * count);
+		return data;
+	}
+
+	// fill the block by doubling the already-copied region, so we only do log2(count) memcpy calls
+	SDL_memcpy(data, in_data_copy, element_size);
+	Uint64 copied = 1;
+	while(copied < (Uint64)count)
+	{
+		Uint64 to_copy = SDL_min(copied, count - copied);
+		SDL_memcpy(data + copied * element_size, data, to_copy * element_size);
+		copied += to_copy;
+	}
+
+	return data;
+}
+
 void itu_component_pool_data_get(ITU_Component* component_pool, ITU_EntityId entity, void* out_data_copy)
 {
 	SDL_assert(component_pool);
@@ -564,13 +933,21 @@ void itu_component_pool_remove(ITU_Component* component_pool, ITU_EntityId entit
 	SDL_assert(component_pool);
 	SDL_assert(component_pool->data_loc[entity.index] != -1);
 
-	Uint64 loc_curr = entity.index;
+	// swap-remove: the last element is moved in the removed slot
+	// NOTE: slots are not entity indices (pools can be smaller than ENTITIES_COUNT_MAX), always go through `data_loc`
+	Uint64 loc_curr = component_pool->data_loc[entity.index];
 	Uint64 loc_last = component_pool->count_alive - 1;
-	component_pool->entity_ids[loc_curr] = component_pool->entity_ids[loc_last];
+	ITU_EntityId entity_last = component_pool->entity_ids[loc_last];
+	if(loc_curr != loc_last)
+	{
+		component_pool->entity_ids[loc_curr] = entity_last;
 
-	void* ptr_curr = pointer_offset(void, component_pool->data, loc_curr * component_pool->element_size);
-	void* ptr_last = pointer_offset(void, component_pool->data, loc_last * component_pool->element_size);
-	SDL_memcpy(ptr_curr, ptr_last, component_pool->element_size);
+		void* ptr_curr = pointer_offset(void, component_pool->data, loc_curr * component_pool->element_size);
+		void* ptr_last = pointer_offset(void, component_pool->data, loc_last * component_pool->element_size);
+		SDL_memcpy(ptr_curr, ptr_last, component_pool->element_size);
+	}
+	component_pool->data_loc[entity_last.index] = loc_curr;
+	component_pool->data_loc[entity.index] = -1;
 
 	component_pool->count_alive--;
 }
@@ -602,6 +979,26 @@ ITU_EntityId itu_entity_create()
 	return entity_data.id;
 }
 
+// creates `count` entities at once, writing their ids in `out_ids`
+// NOTE: free slots are recycled first, like `itu_entity_create()` does. New slots are then appended with a single grow
+void itu_entity_create_batch(ITU_EntityId* out_ids, int count)
+{
+	int i = 0;
+	for(; i < count && stbds_arrlen(ctx_estorage.entities_free) > 0; ++i)
+		out_ids[i] = itu_entity_create();
+
+	int count_new = count - i;
+	int index_first = stbds_arrlen(ctx_estorage.entities);
+	ITU_Entity* entities_new = stbds_arraddnptr(ctx_estorage.entities, count_new);
+	for(int j = 0; j < count_new; ++j)
+	{
+		entities_new[j].id.generation = 0;
+		entities_new[j].id.index = index_first + j;
+		entities_new[j].component_mask = 0;
+		out_ids[i + j] = entities_new[j].id;
+	}
+}
+
 void  itu_entity_set_debug_name(ITU_EntityId id, const char* debug_name)
 {
 	// NOTE: allocating every single name is BAD, but we haven't looked in allocaiton startegies and memory arenas yet
@@ -620,7 +1017,8 @@ bool itu_entity_equals(ITU_EntityId a, ITU_EntityId b)
 
 bool itu_entity_is_valid(ITU_EntityId id)
 {
-	return id.index != -1 && ctx_estorage.entities[id.index].id.generation == id.generation;
+	// NOTE: this also rejects `ITU_ENTITY_ID_NULL` (its index is way out of bounds)
+	return id.index < (Uint32)stbds_arrlen(ctx_estorage.entities) && ctx_estorage.entities[id.index].id.generation == id.generation;
 }
 
 void itu_entity_id_to_stringid(ITU_EntityId id, char* buffer, int max_len)
@@ -655,6 +1053,25 @@ void itu_entity_component_add(ITU_EntityId id, ITU_ComponentType component_type,
 		itu_component_pool_data_set(component, id, in_data_copy);
 }
 
+// adds the same component to all given entities, copying `in_data_copy` in a contiguous block of the component pool
+// returns a pointer to the first element of the block (elements are contiguous and in the same order as `ids`)
+// NOTE: all entities must be valid and must NOT have the component already
+void* itu_entity_component_add_batch(ITU_EntityId* ids, int count, ITU_ComponentType component_type, void* in_data_copy)
+{
+	SDL_assert(component_type < COMPONENTS_COUNT_MAX);
+	Uint64 component_bit = 1ll << component_type;
+
+	for(int i = 0; i < count; ++i)
+	{
+		SDL_assert(itu_entity_is_valid(ids[i]));
+		SDL_assert(!(ctx_estorage.entities[ids[i].index].component_mask & component_bit));
+		ctx_estorage.entities[ids[i].index].component_mask |= component_bit;
+	}
+
+	ITU_Component* component = ctx_estorage.components[component_type];
+	return itu_component_pool_assign_batch(component, ids, count, in_data_copy);
+}
+
 void itu_entity_component_remove(ITU_EntityId id, ITU_ComponentType component_type)
 {
 	SDL_assert(component_type < COMPONENTS_COUNT_MAX);
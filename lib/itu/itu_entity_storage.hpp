@@ -17,9 +17,14 @@
 #define TAGS_COUNT_MAX        64
 
 #define SYSTEMS_COUNT_MAX     64
+#define EVENT_TYPES_COUNT_MAX 32
 #define SYSTEM_COMPONENTS_MAX  8
 #define SYSTEM_TAGS_MAX        8
-#define ENTITIES_COUNT_MAX 4096 * 4
+
+// NOTE: every standard component pool is allocated for this many entities, games that need more can define it before including
+#ifndef ENTITIES_COUNT_MAX
+#define ENTITIES_COUNT_MAX (4096 * 4)
+#endif
 
 #define ITU_ENTITY_ID_NULL { (Uint32)-1, (Uint32)-1 }
 
@@ -32,10 +37,15 @@ struct ITU_EntityId
 
 typedef Uint8 ITU_ComponentType;
 typedef Uint8 ITU_TagType;
+typedef Uint8 ITU_EventType;
 
 // signature for a system-like update function
 typedef void (*ITU_SystemUpdateFunction)(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count);
 
+// signature for a system that reads an event channel
+// `events` points to a contiguous array of `events_count` elements of the event type the system was registered with
+typedef void (*ITU_SystemEventsFunction)(SDLContext* context, void* events, int events_count);
+
 // signature for a component debug UI render function
 typedef void (*ITU_ComponendDebugUIRender)(SDLContext* context, void* data);
 
@@ -45,6 +55,7 @@ struct ITU_SystemDef
 	ITU_SystemUpdateFunction fn_update;
 	Uint64 component_mask;
 	Uint64 tag_mask;
+	Uint64 component_mask_exclude; // entities having any of these components are skipped
 };
 
 #define register_component(T) ITU_ComponentType ITU_COMPONENT_TYPE_##T; const char* ITU_COMPONENT_NAME_##T = #T;
@@ -55,11 +66,20 @@ struct ITU_SystemDef
 #define entity_get_data(id, T) (T*)itu_entity_data_get((id), ITU_COMPONENT_TYPE_##T)
 
 #define add_system(fn_update, component_mask, tag_mask) itu_sys_estorage_add_system({ #fn_update, fn_update, component_mask, tag_mask })
+#define add_system_exclude(fn_update, component_mask, tag_mask, component_mask_exclude) itu_sys_estorage_add_system({ #fn_update, fn_update, component_mask, tag_mask, component_mask_exclude })
 #define entity_add_component(id, T, value) { type_check_struct(T, value); itu_entity_component_add((id), ITU_COMPONENT_TYPE_##T, &value); }
 
 #define component_mask(T) (1ull << ITU_COMPONENT_TYPE_##T)
 #define component_type(T) ITU_COMPONENT_TYPE_##T
 
+// event channels
+// events pushed during a frame are readable (as a contiguous batch) during the whole NEXT frame, then discarded
+#define register_event(T) ITU_EventType ITU_EVENT_TYPE_##T; const char* ITU_EVENT_NAME_##T = #T;
+#define enable_event(T) itu_sys_estorage_add_event_channel(sizeof(T), &ITU_EVENT_TYPE_##T, ITU_EVENT_NAME_##T)
+#define events_push(T, value) { type_check_struct(T, value); itu_sys_estorage_events_push(ITU_EVENT_TYPE_##T, &value); }
+#define events_read(T, out_count) (T*)itu_sys_estorage_events_read(ITU_EVENT_TYPE_##T, (out_count))
+#define add_event_system(fn_update, T) itu_sys_estorage_add_event_system(#fn_update, fn_update, ITU_EVENT_TYPE_##T)
+
 #define tag_mask(tag) (1ull << tag)
 #define set_tag_debug_name(tag, name) 
 
@@ -70,6 +90,9 @@ register_component(Sprite)
 register_component(PhysicsData)
 register_component(PhysicsStaticData)
 register_component(ShapeData)
+register_component(Tilemap)
+register_component(Contacts)
+register_component(Collider)
 
 void itu_sys_estorage_init(int starting_entities_count, bool enable_standard_components);
 void itu_sys_estorage_clear_all_entities();
@@ -77,10 +100,16 @@ void itu_sys_estorage_add_system(ITU_SystemDef system_def);
 void itu_sys_estorage_set_systems(ITU_SystemDef* systems, int systems_count);
 void itu_sys_estorage_systems_update(SDLContext* context);
 
+ITU_EventType itu_sys_estorage_add_event_channel(Uint64 element_size, ITU_EventType* ref_event_type, const char* event_name);
+void  itu_sys_estorage_add_event_system(const char* name, ITU_SystemEventsFunction fn_update, ITU_EventType event_type);
+void  itu_sys_estorage_events_push(ITU_EventType event_type, void* in_data_copy);
+void* itu_sys_estorage_events_read(ITU_EventType event_type, int* out_count);
+
 void itu_sys_estorage_tag_set_debug_name(int tag, const char* tag_debug_name);
 void itu_sys_estorage_debug_render(SDLContext* context);
 
 ITU_EntityId itu_entity_create();
+void  itu_entity_create_batch    (ITU_EntityId* out_ids, int count);
 void  itu_entity_set_debug_name  (ITU_EntityId id, const char* debug_name);
 bool  itu_entity_equals          (ITU_EntityId a, ITU_EntityId b);
 bool  itu_entity_is_valid        (ITU_EntityId id);
@@ -90,6 +119,7 @@ void  itu_entity_tag_add         (ITU_EntityId id, ITU_TagType tag);
 void  itu_entity_tag_remove      (ITU_EntityId id, ITU_TagType tag);
 bool  itu_entity_tag_has         (ITU_EntityId id, ITU_TagType tag);
 void  itu_entity_component_add   (ITU_EntityId id, ITU_ComponentType component_type, void* in_data_copy);
+void* itu_entity_component_add_batch(ITU_EntityId* ids, int count, ITU_ComponentType component_type, void* in_data_copy);
 void  itu_entity_component_remove(ITU_EntityId id, ITU_ComponentType component_type);
 void  itu_entity_destroy         (ITU_EntityId id);
 
@@ -0,0 +1,120 @@
+// itu_lib_arena.hpp
+// simple linear (bump) allocator
+// allocations are just a pointer increment, and everything is freed at once by resetting the arena
+//
+// the library also provides a ring of two "frame arenas":
+// - the current one, where anything that only needs to live until the end of the next frame can be allocated
+// - the previous one, which still holds the data allocated last frame (ie, double-buffered data)
+// `itu_lib_arena_frame_begin()` swaps them and resets the new current one. It is called once per frame by
+// `itu_sys_estorage_systems_update()`, call it manually if you are not using the entity storage
+//
+// limitations
+// - arenas do not grow. Allocations that do not fit return NULL (and log a warning)
+
+#ifndef ITU_LIB_ARENA_HPP
+#define ITU_LIB_ARENA_HPP
+
+#ifndef ITU_UNITY_BUILD
+#include <SDL3/SDL.h>
+#include <itu_common.hpp>
+#endif
+
+#ifndef ARENA_FRAME_SIZE
+#define ARENA_FRAME_SIZE MB(16)
+#endif
+
+struct ITU_Arena
+{
+	unsigned char* data;
+	Uint64 size;
+	Uint64 used;
+	Uint64 used_max; // high watermark, for diagnostics
+};
+
+// allocates an array of `count` elements of type `T` from the given arena
+#define arena_push_array(arena, T, count) (T*)itu_lib_arena_alloc((arena), sizeof(T) * (count), alignof(T))
+
+void  itu_lib_arena_init(ITU_Arena* arena, Uint64 size);
+void  itu_lib_arena_free(ITU_Arena* arena);
+void* itu_lib_arena_alloc(ITU_Arena* arena, Uint64 size, Uint64 alignment);
+void  itu_lib_arena_reset(ITU_Arena* arena);
+
+void       itu_lib_arena_frame_begin();
+ITU_Arena* itu_lib_arena_frame();
+ITU_Arena* itu_lib_arena_frame_prev();
+
+#endif // ITU_LIB_ARENA_HPP
+
+#if (defined ITU_LIB_ARENA_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
+
+static ITU_Arena arenas_frame[2];
+static int       arenas_frame_curr;
+
+void itu_lib_arena_init(ITU_Arena* arena, Uint64 size)
+{
+	arena->data = (unsigned char*)SDL_malloc(size);
+	arena->size = size;
+	arena->used = 0;
+	arena->used_max = 0;
+
+	SDL_assert(arena->data);
+}
+
+void itu_lib_arena_free(ITU_Arena* arena)
+{
+	SDL_free(arena->data);
+	*arena = { 0 };
+}
+
+// NOTE: `alignment` must be a power of 2
+void* itu_lib_arena_alloc(ITU_Arena* arena, Uint64 size, Uint64 alignment)
+{
+	SDL_assert(arena->data);
+	SDL_assert((alignment & (alignment - 1)) == 0);
+
+	Uint64 address = (Uint64)(arena->data + arena->used);
+	Uint64 padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+
+	if(arena->used + padding + size > arena->size)
+	{
+		SDL_Log("WARNING arena out of memory (requested %llu bytes, %llu/%llu used)\n", (unsigned long long)size, (unsigned long long)arena->used, (unsigned long long)arena->size);
+		return NULL;
+	}
+
+	void* ret = arena->data + arena->used + padding;
+	arena->used += padding + size;
+	arena->used_max = SDL_max(arena->used_max, arena->used);
+
+	return ret;
+}
+
+void itu_lib_arena_reset(ITU_Arena* arena)
+{
+	arena->used = 0;
+}
+
+void itu_lib_arena_frame_begin()
+{
+	arenas_frame_curr = 1 - arenas_frame_curr;
+
+	ITU_Arena* arena = &arenas_frame[arenas_frame_curr];
+	if(!arena->data)
+		itu_lib_arena_init(arena, ARENA_FRAME_SIZE);
+	itu_lib_arena_reset(arena);
+}
+
+ITU_Arena* itu_lib_arena_frame()
+{
+	// lazy init, so that we can allocate even before the first `itu_lib_arena_frame_begin()`
+	ITU_Arena* arena = &arenas_frame[arenas_frame_curr];
+	if(!arena->data)
+		itu_lib_arena_init(arena, ARENA_FRAME_SIZE);
+	return arena;
+}
+
+ITU_Arena* itu_lib_arena_frame_prev()
+{
+	return &arenas_frame[1 - arenas_frame_curr];
+}
+
+#endif // (defined ITU_LIB_ARENA_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
@@ -6,6 +6,8 @@ void itu_debug_ui_render_sprite(SDLContext* context, void* data);
 void itu_debug_ui_render_physicsdata(SDLContext* context, void* data);
 void itu_debug_ui_render_physicsstaticdata(SDLContext* context, void* data);
 void itu_debug_ui_render_shapedata(SDLContext* context, void* data);
+void itu_debug_ui_render_contacts(SDLContext* context, void* data);
+void itu_debug_ui_render_collider(SDLContext* context, void* data);
 
 #endif // ITU_LIB_DEBUG_UI_HPP
 
@@ -52,6 +54,7 @@ void itu_debug_ui_render_physicsdata(SDLContext* context, void* data)
 
 	ImGui::DragFloat2("velocity", &data_body->velocity.x);
 	ImGui::DragFloat("torque", &data_body->torque);
+	ImGui::Checkbox("extrapolate", &data_body->extrapolate);
 
 	// TODO show definition data (either here, or in a more appropriate place)
 }
@@ -64,6 +67,83 @@ void itu_debug_ui_render_physicsstaticdata(SDLContext* context, void* data)
 
 }
 
+const char* const physics_contact_type_names[7] =
+{
+	"contact begin",
+	"contact end",
+	"hit",
+	"sensor begin",
+	"sensor end",
+	"visit begin",
+	"visit end",
+};
+
+void itu_debug_ui_render_contacts(SDLContext* context, void* data)
+{
+	Contacts* data_contacts = (Contacts*)data;
+
+	int count = itu_sys_physics_contacts_count(data_contacts);
+	ImGui::Text("contacts this frame: %d", count);
+	for(int i = 0; i < count; ++i)
+	{
+		PhysicsContact* contact = itu_sys_physics_contacts_get(data_contacts, i);
+		ImGui::PushID(i);
+		ImGui::Text("%s", physics_contact_type_names[contact->type]);
+		itu_debug_ui_widget_entityid("other", contact->other);
+		if(contact->type == PHYSICS_CONTACT_BEGIN || contact->type == PHYSICS_CONTACT_HIT)
+			ImGui::Text("normal %.2f %.2f", contact->normal.x, contact->normal.y);
+		ImGui::PopID();
+	}
+}
+
+const char* const collider_type_names[3] =
+{
+	"circle",
+	"rect",
+	"polygon",
+};
+
+void itu_debug_ui_render_collider(SDLContext* context, void* data)
+{
+	Collider* data_collider = (Collider*)data;
+
+	int type_idx = (int)data_collider->type;
+	if(ImGui::Combo("type", &type_idx, collider_type_names, 3) && type_idx != data_collider->type)
+	{
+		// NOTE: switching type resets the shape (polygons start as an empty shape), everything else is kept
+		vec2f offset = data_collider->offset;
+		bool is_static = data_collider->is_static;
+		bool is_sensor = data_collider->is_sensor;
+		if(type_idx == COLLIDER_CIRCLE)
+			*data_collider = itu_sys_collisions_make_circle(0.5f, offset);
+		else if(type_idx == COLLIDER_RECT)
+			*data_collider = itu_sys_collisions_make_rect(vec2f{ 0.5f, 0.5f }, offset);
+		else
+			*data_collider = itu_sys_collisions_make_polygon(NULL, 0, offset);
+		data_collider->is_static = is_static;
+		data_collider->is_sensor = is_sensor;
+	}
+
+	ImGui::DragFloat2("offset", &data_collider->offset.x, 0.01f);
+	switch(data_collider->type)
+	{
+		case COLLIDER_CIRCLE:  ImGui::DragFloat("radius", &data_collider->radius, 0.01f, 0.0f); break;
+		case COLLIDER_RECT:    ImGui::DragFloat2("half size", &data_collider->half_size.x, 0.01f, 0.0f); break;
+		case COLLIDER_POLYGON:
+		{
+			for(int i = 0; i < data_collider->polygon.vertices_count; ++i)
+			{
+				ImGui::PushID(i);
+				ImGui::DragFloat2("vertex", &data_collider->polygon.vertices[i].x, 0.01f);
+				ImGui::PopID();
+			}
+			break;
+		}
+	}
+	ImGui::Checkbox("static", &data_collider->is_static);
+	ImGui::Checkbox("sensor", &data_collider->is_sensor);
+}
+
 const char* const b2_shape_names[6] = 
 {
 	"circle",
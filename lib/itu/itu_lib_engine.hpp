@@ -40,6 +40,26 @@ struct Transform
 
 struct SDLContext;
 
+// axis-aligned affine transform (cameras can't rotate, so there's no need for a full matrix)
+// p' = p * scale + translation
+struct CameraTransform
+{
+	vec2f scale;
+	vec2f translation;
+};
+
+// everything the camera transforms depend on, used to detect when the cached ones are stale
+struct CameraTransformKey
+{
+	vec2f world_position;
+	vec2f normalized_screen_size;
+	vec2f normalized_screen_offset;
+	float zoom;
+	float pixels_per_unit;
+	float window_w;
+	float window_h;
+};
+
 struct Camera
 {
 	vec2f world_position; // world position
@@ -47,6 +67,13 @@ struct Camera
 	vec2f normalized_screen_offset;   // NORMALIZED offset (inside the screen rect)
 	float zoom;
 	float pixels_per_unit;
+
+	// cached transforms, recomputed lazily when any of the fields above (or the window size) change
+	// NOTE: don't access them directly, use `camera_get_transform_world_to_screen()` and `camera_get_transform_screen_to_world()`
+	CameraTransformKey cache_key;
+	CameraTransform    cache_world_to_screen;
+	CameraTransform    cache_screen_to_world;
+	bool               cache_valid;
 };
 
 struct SDLContext
@@ -55,6 +82,8 @@ struct SDLContext
 
 	SDL_Window* window;
 	SDL_Renderer* renderer;
+	SDL_Texture* headless_target; // offscreen render target, only used in headless mode (see `sdl_context_create_window()`)
+	bool headless;
 	float zoom;     // render zoom
 	float window_w;	// current window width after render zoom has been applied
 	float window_h;	// current window width after render zoom has been applied
@@ -66,6 +95,10 @@ struct SDLContext
 	SDL_Time accumulator_physics;
 	int physics_steps_count;
 
+	// culling diagnostics (updated every frame by the sprite render system)
+	int sprites_drawn_count;
+	int sprites_culled_count;
+
 	Camera* camera_active;
 	Camera camera_default; // default camera
 
@@ -109,10 +142,17 @@ struct SDLContext
 
 #define TRANSFORM_DEFAULT Transform { { 0, 0 }, { 1, 1 }, 0 }
 
+bool sdl_context_create_window(SDLContext* context, const char* title, int w, int h, const char* renderer_name, bool headless);
+void sdl_context_present(SDLContext* context);
 void camera_set_active(SDLContext* context, Camera* camera);
+SDL_FRect camera_get_world_rect(SDLContext* context, Camera* camera);
+CameraTransform camera_get_transform_world_to_screen(SDLContext* context, Camera* camera);
+CameraTransform camera_get_transform_screen_to_world(SDLContext* context, Camera* camera);
 SDL_FRect rect_global_to_screen(SDLContext* context, SDL_FRect rect);
 vec2f point_global_to_screen(SDLContext* context, vec2f p);
 vec2f point_screen_to_global(SDLContext* context, vec2f p);
+void points_global_to_screen(SDLContext* context, vec2f* in, vec2f* out, int count);
+void points_screen_to_global(SDLContext* context, vec2f* in, vec2f* out, int count);
 vec2f point_screen_to_window(SDLContext* context, vec2f p);
 vec2f point_window_to_screen(SDLContext* context, vec2f p);
 void sdl_input_clear(SDLContext* context);
@@ -125,6 +165,67 @@ void sdl_set_texture_tint(SDL_Texture* texture, color c);
 
 #if (defined ITU_LIB_ENGINE_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
 
+// creates window and renderer (`renderer_name` can be NULL to let SDL pick the best one)
+// in headless mode no display or GPU is needed: the offscreen (or dummy) video driver and the software renderer are used,
+// and everything is drawn to an offscreen texture. Useful to benchmark rendering reproducibly on CI machines
+// NOTE: headless mode must be requested before anything else initializes the video subsystem
+bool sdl_context_create_window(SDLContext* context, const char* title, int w, int h, const char* renderer_name, bool headless)
+{
+	SDL_WindowFlags window_flags = 0;
+	context->headless = headless;
+	if(headless)
+	{
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen,dummy");
+		renderer_name = SDL_SOFTWARE_RENDERER;
+		window_flags |= SDL_WINDOW_HIDDEN;
+	}
+
+	if(!SDL_InitSubSystem(SDL_INIT_VIDEO))
+	{
+		SDL_Log("ERROR failed to initialize video: %s\n", SDL_GetError());
+		return false;
+	}
+
+	context->window = SDL_CreateWindow(title, w, h, window_flags);
+	if(!context->window)
+	{
+		SDL_Log("ERROR failed to create window: %s\n", SDL_GetError());
+		return false;
+	}
+
+	context->renderer = SDL_CreateRenderer(context->window, renderer_name);
+	if(!context->renderer)
+	{
+		SDL_Log("ERROR failed to create renderer '%s': %s\n", renderer_name ? renderer_name : "default", SDL_GetError());
+		return false;
+	}
+
+	if(headless)
+	{
+		context->headless_target = SDL_CreateTexture(context->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+		if(!context->headless_target)
+		{
+			SDL_Log("ERROR failed to create headless render target: %s\n", SDL_GetError());
+			return false;
+		}
+		SDL_SetRenderTarget(context->renderer, context->headless_target);
+	}
+
+	SDL_SetRenderDrawBlendMode(context->renderer, SDL_BLENDMODE_BLEND);
+	return true;
+}
+
+// presents the frame on screen
+// in headless mode there's nothing to present, but we still need to flush the renderer so that
+// the frame cost is actually paid (and measured) every frame
+void sdl_context_present(SDLContext* context)
+{
+	if(context->headless)
+		SDL_FlushRenderer(context->renderer);
+	else
+		SDL_RenderPresent(context->renderer);
+}
+
 void camera_set_active(SDLContext* context, Camera* camera)
 {
 	context->camera_active = camera;
@@ -149,13 +250,37 @@ SDL_FRect camera_get_viewport_rect(SDLContext* context, Camera* camera)
 	return rect;
 }
 
-// converts the given rect to the viewport of the given camera
-SDL_FRect rect_global_to_screen(SDLContext* context, SDL_FRect rect)
+// returns the world-space rect seen by the given camera (`x` and `y` are the bottom-left corner)
+SDL_FRect camera_get_world_rect(SDLContext* context, Camera* camera)
 {
-	SDL_assert(context);
-	Camera* camera = context->camera_active;
+	vec2f camera_size;
+	camera_size.x = (context->window_w / camera->pixels_per_unit) * camera->normalized_screen_size.x / camera->zoom;
+	camera_size.y = (context->window_h / camera->pixels_per_unit) * camera->normalized_screen_size.y / camera->zoom;
 
-	SDL_assert(camera);
+	SDL_FRect rect;
+	rect.x = camera->world_position.x - camera_size.x / 2;
+	rect.y = camera->world_position.y - camera_size.y / 2;
+	rect.w = camera_size.x;
+	rect.h = camera_size.y;
+
+	return rect;
+}
+
+// recomputes the cached camera transforms, if anything they depend on changed since last time
+static void camera_update_transforms(SDLContext* context, Camera* camera)
+{
+	CameraTransformKey key;
+	SDL_zero(key);
+	key.world_position = camera->world_position;
+	key.normalized_screen_size = camera->normalized_screen_size;
+	key.normalized_screen_offset = camera->normalized_screen_offset;
+	key.zoom = camera->zoom;
+	key.pixels_per_unit = camera->pixels_per_unit;
+	key.window_w = context->window_w;
+	key.window_h = context->window_h;
+
+	if(camera->cache_valid && SDL_memcmp(&key, &camera->cache_key, sizeof(CameraTransformKey)) == 0)
+		return;
 
 	vec2f camera_size;
 	camera_size.x = (context->window_w / camera->pixels_per_unit) * camera->normalized_screen_size.x;
@@ -165,23 +290,57 @@ SDL_FRect rect_global_to_screen(SDLContext* context, SDL_FRect rect)
 	camera_offset.x = (context->window_w / camera->pixels_per_unit)* camera->normalized_screen_offset.x;
 	camera_offset.y = (context->window_h / camera->pixels_per_unit)* camera->normalized_screen_offset.y;
 
-	vec2f pos  = vec2f{ rect.x, rect.y };
-	vec2f size = vec2f{ rect.w, rect.h };
+	// world -> screen
+	// 1. move to camera space         (p - world_position)
+	// 2. apply zoom and center        (* zoom + camera_size / 2)
+	// 3. flip the y-axis              (camera_size.y - y)
+	// 4. convert to pixels and offset (* pixels_per_unit + camera_offset)
+	CameraTransform* w2s = &camera->cache_world_to_screen;
+	w2s->scale.x =  camera->zoom * camera->pixels_per_unit;
+	w2s->scale.y = -camera->zoom * camera->pixels_per_unit;
+	w2s->translation.x = (camera_size.x / 2 - camera->world_position.x * camera->zoom) * camera->pixels_per_unit + camera_offset.x;
+	w2s->translation.y = (camera_size.y / 2 + camera->world_position.y * camera->zoom) * camera->pixels_per_unit + camera_offset.y;
+
+	// screen -> world (same steps, in reverse)
+	// NOTE: `camera_offset` is removed in world units here, so this is the exact inverse of the above only for cameras without offset
+	CameraTransform* s2w = &camera->cache_screen_to_world;
+	s2w->scale.x =  1 / (camera->zoom * camera->pixels_per_unit);
+	s2w->scale.y = -1 / (camera->zoom * camera->pixels_per_unit);
+	s2w->translation.x = (-camera_size.x / 2 - camera_offset.x) / camera->zoom + camera->world_position.x;
+	s2w->translation.y = ( camera_size.y / 2 - camera_offset.y) / camera->zoom + camera->world_position.y;
+
+	camera->cache_key = key;
+	camera->cache_valid = true;
+}
 
-	pos = pos - camera->world_position;
-	pos = pos * camera->zoom;
-	// pos = pos + camera->normalized_screen_size / 2;
-	// pos.y = camera->normalized_screen_size.y - pos.y - size.y * camera->zoom;
-	pos = pos + camera_size / 2;
-	pos.y = camera_size.y - pos.y - size.y * camera->zoom;
-	
+CameraTransform camera_get_transform_world_to_screen(SDLContext* context, Camera* camera)
+{
+	camera_update_transforms(context, camera);
+	return camera->cache_world_to_screen;
+}
+
+CameraTransform camera_get_transform_screen_to_world(SDLContext* context, Camera* camera)
+{
+	camera_update_transforms(context, camera);
+	return camera->cache_screen_to_world;
+}
+
+// converts the given rect to the viewport of the given camera
+SDL_FRect rect_global_to_screen(SDLContext* context, SDL_FRect rect)
+{
+	SDL_assert(context);
+	Camera* camera = context->camera_active;
+
+	SDL_assert(camera);
+
+	CameraTransform t = camera_get_transform_world_to_screen(context, camera);
+
+	// NOTE: y-axis is flipped, so the top of the rect in screen space is the top (max y) of the rect in world space
 	SDL_FRect ret;
-	ret.w = camera->pixels_per_unit * size.x * camera->zoom;
-	ret.h = camera->pixels_per_unit * size.y * camera->zoom;
-	// ret.x = camera->pixels_per_unit * pos.x;
-	// ret.y = camera->pixels_per_unit * pos.y;
-	ret.x = camera->pixels_per_unit * pos.x + camera_offset.x;
-	ret.y = camera->pixels_per_unit * pos.y + camera_offset.y;
+	ret.x = rect.x * t.scale.x + t.translation.x;
+	ret.y = (rect.y + rect.h) * t.scale.y + t.translation.y;
+	ret.w =  rect.w * t.scale.x;
+	ret.h = -rect.h * t.scale.y;
 
 	return ret;
 }
@@ -205,20 +364,11 @@ vec2f point_global_to_screen(SDLContext* context,vec2f p)
 
 	SDL_assert(camera);
 
-	vec2f camera_size;
-	camera_size.x = (context->window_w / camera->pixels_per_unit) * camera->normalized_screen_size.x;
-	camera_size.y = (context->window_h / camera->pixels_per_unit) * camera->normalized_screen_size.y;
-	
-	vec2f camera_offset;
-	camera_offset.x = (context->window_w / camera->pixels_per_unit)* camera->normalized_screen_offset.x;
-	camera_offset.y = (context->window_h / camera->pixels_per_unit)* camera->normalized_screen_offset.y;
+	CameraTransform t = camera_get_transform_world_to_screen(context, camera);
 
-	vec2f ret = p;
-	ret = ret - camera->world_position;
-	ret = ret * camera->zoom;
-	ret = ret + camera_size / 2;
-	ret.y = camera_size.y - ret.y;
-	ret = ret * camera->pixels_per_unit + camera_offset;
+	vec2f ret;
+	ret.x = p.x * t.scale.x + t.translation.x;
+	ret.y = p.y * t.scale.y + t.translation.y;
 
 	return ret;
 }
@@ -231,25 +381,64 @@ vec2f point_screen_to_global(SDLContext* context, vec2f p)
 
 	SDL_assert(camera);
 
-	vec2f camera_size;
-	camera_size.x = (context->window_w / camera->pixels_per_unit) * camera->normalized_screen_size.x;
-	camera_size.y = (context->window_h / camera->pixels_per_unit) * camera->normalized_screen_size.y;
+	CameraTransform t = camera_get_transform_screen_to_world(context, camera);
 
-	vec2f camera_offset;
-	camera_offset.x = (context->window_w / camera->pixels_per_unit)* camera->normalized_screen_offset.x;
-	camera_offset.y = (context->window_h / camera->pixels_per_unit)* camera->normalized_screen_offset.y;
-
-	vec2f ret = p;
-	ret = ret / camera->pixels_per_unit;
-	ret.y = camera_size.y - ret.y;
-	ret = ret - camera_offset;
-	ret = ret - camera_size / 2;
-	ret = ret / camera->zoom;
-	ret = ret + camera->world_position;
+	vec2f ret;
+	ret.x = p.x * t.scale.x + t.translation.x;
+	ret.y = p.y * t.scale.y + t.translation.y;
 
 	return ret;
 }
 
+// applies the transform to `count` points (`in` and `out` can be the same array)
+static void camera_transform_points(CameraTransform t, vec2f* in, vec2f* out, int count)
+{
+	// points are stored interleaved (x0, y0, x1, y1, ...), so we process them in pairs with (sx, sy, sx, sy) and (tx, ty, tx, ty)
+	float* src = (float*)in;
+	float* dst = (float*)out;
+	int i = 0;
+
+#if defined(ITU_SIMD_AVX2)
+	__m256 v_scale_8 = _mm256_setr_ps(t.scale.x, t.scale.y, t.scale.x, t.scale.y, t.scale.x, t.scale.y, t.scale.x, t.scale.y);
+	__m256 v_trans_8 = _mm256_setr_ps(t.translation.x, t.translation.y, t.translation.x, t.translation.y, t.translation.x, t.translation.y, t.translation.x, t.translation.y);
+	for(; i + 4 <= count; i += 4)
+		_mm256_storeu_ps(dst + i * 2, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i * 2), v_scale_8), v_trans_8));
+#endif
+#if defined(ITU_SIMD_SSE2)
+	__m128 v_scale = _mm_setr_ps(t.scale.x, t.scale.y, t.scale.x, t.scale.y);
+	__m128 v_trans = _mm_setr_ps(t.translation.x, t.translation.y, t.translation.x, t.translation.y);
+	for(; i + 2 <= count; i += 2)
+		_mm_storeu_ps(dst + i * 2, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i * 2), v_scale), v_trans));
+#elif defined(ITU_SIMD_NEON)
+	const float32x4_t v_scale = { t.scale.x, t.scale.y, t.scale.x, t.scale.y };
+	const float32x4_t v_trans = { t.translation.x, t.translation.y, t.translation.x, t.translation.y };
+	for(; i + 2 <= count; i += 2)
+		vst1q_f32(dst + i * 2, vmlaq_f32(v_trans, vld1q_f32(src + i * 2), v_scale));
+#endif
+
+	// scalar path (also handles the remainder of the SIMD loops)
+	for(; i < count; ++i)
+	{
+		out[i].x = in[i].x * t.scale.x + t.translation.x;
+		out[i].y = in[i].y * t.scale.y + t.translation.y;
+	}
+}
+
+// converts `count` points to the viewport of the active camera
+// NOTE: `vec2f` and `SDL_FPoint` have the same layout, so this can write directly into vertex/point buffers
+void points_global_to_screen(SDLContext* context, vec2f* in, vec2f* out, int count)
+{
+	SDL_assert(context && context->camera_active);
+	camera_transform_points(camera_get_transform_world_to_screen(context, context->camera_active), in, out, count);
+}
+
+// converts `count` points from the viewport of the active camera to world space
+void points_screen_to_global(SDLContext* context, vec2f* in, vec2f* out, int count)
+{
+	SDL_assert(context && context->camera_active);
+	camera_transform_points(camera_get_transform_screen_to_world(context, context->camera_active), in, out, count);
+}
+
 vec2f point_screen_to_window(SDLContext* context, vec2f p)
 {
 	vec2f ret = p + mul_element_wise(context->camera_active->normalized_screen_offset, vec2f { WINDOW_W, WINDOW_H});
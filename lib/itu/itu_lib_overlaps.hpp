@@ -47,6 +47,9 @@ bool itu_lib_overlaps_circle_polygon(vec2f circle_center, float circle_radius, v
 bool itu_lib_overlaps_rect_polygon(vec2f rect_min, vec2f rect_max, vec2f* polygon_vertices, int poligon_vertices_count);
 bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, vec2f* out_simplex, int* out_simplex_count);
 
+// batch tests (SIMD when available)
+int itu_lib_overlaps_rects_rect(float* rects_min_x, float* rects_min_y, float* rects_max_x, float* rects_max_y, int rects_count, vec2f rect_min, vec2f rect_max, int* out_indices);
+
 #endif // ITU_LIB_COLLISIONS_HPP
 
 #if defined ITU_LIB_OVERLAPS_IMPLEMENTATION || defined ITU_UNITY_BUILD
@@ -405,4 +408,60 @@ bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_v
 	return ret;
 }
 
+// tests `rects_count` rects (in SoA layout) against a single rect, writing the indices of the overlapping ones in `out_indices`
+// returns the number of overlapping rects. Same rules of `itu_lib_overlaps_rect_rect()` (strict disequalities)
+// NOTE: mostly useful for culling, where the single rect is the camera
+int itu_lib_overlaps_rects_rect(float* rects_min_x, float* rects_min_y, float* rects_max_x, float* rects_max_y, int rects_count, vec2f rect_min, vec2f rect_max, int* out_indices)
+{
+	int ret = 0;
+	int i = 0;
+
+#if defined(ITU_SIMD_SSE2)
+	__m128 v_min_x = _mm_set1_ps(rect_min.x);
+	__m128 v_min_y = _mm_set1_ps(rect_min.y);
+	__m128 v_max_x = _mm_set1_ps(rect_max.x);
+	__m128 v_max_y = _mm_set1_ps(rect_max.y);
+	for(; i + 4 <= rects_count; i += 4)
+	{
+		__m128 overlap_x = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(rects_min_x + i), v_max_x), _mm_cmpgt_ps(_mm_loadu_ps(rects_max_x + i), v_min_x));
+		__m128 overlap_y = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(rects_min_y + i), v_max_y), _mm_cmpgt_ps(_mm_loadu_ps(rects_max_y + i), v_min_y));
+		Uint32 hits = _mm_movemask_ps(_mm_and_ps(overlap_x, overlap_y));
+
+		while(hits)
+		{
+			out_indices[ret++] = i + bit_ctz32(hits);
+			hits &= hits - 1;
+		}
+	}
+#elif defined(ITU_SIMD_NEON)
+	float32x4_t v_min_x = vdupq_n_f32(rect_min.x);
+	float32x4_t v_min_y = vdupq_n_f32(rect_min.y);
+	float32x4_t v_max_x = vdupq_n_f32(rect_max.x);
+	float32x4_t v_max_y = vdupq_n_f32(rect_max.y);
+	const uint32x4_t lane_bits = { 1, 2, 4, 8 };
+	for(; i + 4 <= rects_count; i += 4)
+	{
+		uint32x4_t overlap_x = vandq_u32(vcltq_f32(vld1q_f32(rects_min_x + i), v_max_x), vcgtq_f32(vld1q_f32(rects_max_x + i), v_min_x));
+		uint32x4_t overlap_y = vandq_u32(vcltq_f32(vld1q_f32(rects_min_y + i), v_max_y), vcgtq_f32(vld1q_f32(rects_max_y + i), v_min_y));
+		Uint32 hits = vaddvq_u32(vandq_u32(vandq_u32(overlap_x, overlap_y), lane_bits));
+
+		while(hits)
+		{
+			out_indices[ret++] = i + bit_ctz32(hits);
+			hits &= hits - 1;
+		}
+	}
+#endif
+
+	// scalar path (also handles the remainder of the SIMD loops)
+	for(; i < rects_count; ++i)
+	{
+		if(rects_min_x[i] < rect_max.x && rects_max_x[i] > rect_min.x &&
+		   rects_min_y[i] < rect_max.y && rects_max_y[i] > rect_min.y)
+			out_indices[ret++] = i;
+	}
+
+	return ret;
+}
+
 #endif // ITU_LIB_COLLISIONS_IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,160 @@
+// itu_lib_prefab.hpp
+// prefabs: entity templates that capture a set of components (and optionally a physics body) once,
+// and can then be instantiated many times with (almost) the cost of a memcpy
+//
+// usage:
+//     ITU_Prefab* prefab = itu_prefab_create();
+//     prefab_add_component(prefab, Transform, transform);
+//     prefab_add_component(prefab, Sprite, sprite);
+//     prefab_add_component(prefab, PhysicsStaticData, physics_data);
+//     prefab_add_component(prefab, ShapeData, shape_data);
+//     itu_prefab_set_body(prefab, &body_def, &shape_def, &shape);
+//     itu_prefab_instantiate(prefab, 1000, positions, out_ids);
+//
+// limitations
+// - component data is copied as-is, so components holding owned pointers will share them across instances
+// - the only per-instance data is the position (in `Transform` and in the physics body), everything else must
+//   be patched by the caller after instantiation
+
+#ifndef ITU_LIB_PREFAB_HPP
+#define ITU_LIB_PREFAB_HPP
+
+#ifndef ITU_UNITY_BUILD
+#include <itu_entity_storage.hpp>
+#include <itu_sys_physics.hpp>
+#endif
+
+struct ITU_Prefab
+{
+	Uint64 component_mask;
+	void*  component_data[COMPONENTS_COUNT_MAX]; // owned copies of the component data, indexed by component type
+	Uint64 tag_mask;
+
+	bool             has_body;
+	b2BodyDef        body_def;
+	b2ShapeDef       shape_def;
+	ITU_PhysicsShape shape;
+};
+
+#define prefab_add_component(prefab, T, value) { type_check_struct(T, value); itu_prefab_component_add((prefab), ITU_COMPONENT_TYPE_##T, &value, sizeof(T)); }
+
+ITU_Prefab* itu_prefab_create();
+void        itu_prefab_destroy(ITU_Prefab* prefab);
+void        itu_prefab_component_add(ITU_Prefab* prefab, ITU_ComponentType component_type, void* in_data_copy, Uint64 size);
+void        itu_prefab_tag_add(ITU_Prefab* prefab, ITU_TagType tag);
+void        itu_prefab_set_body(ITU_Prefab* prefab, b2BodyDef* body_def, b2ShapeDef* shape_def, ITU_PhysicsShape* shape);
+void        itu_prefab_instantiate(ITU_Prefab* prefab, int count, vec2f* positions, ITU_EntityId* out_ids);
+
+#endif // ITU_LIB_PREFAB_HPP
+
+#if (defined ITU_LIB_PREFAB_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
+
+ITU_Prefab* itu_prefab_create()
+{
+	ITU_Prefab* ret = (ITU_Prefab*)SDL_calloc(1, sizeof(ITU_Prefab));
+	return ret;
+}
+
+void itu_prefab_destroy(ITU_Prefab* prefab)
+{
+	for(int i = 0; i < COMPONENTS_COUNT_MAX; ++i)
+		SDL_free(prefab->component_data[i]);
+	SDL_free(prefab);
+}
+
+void itu_prefab_component_add(ITU_Prefab* prefab, ITU_ComponentType component_type, void* in_data_copy, Uint64 size)
+{
+	SDL_assert(component_type < COMPONENTS_COUNT_MAX);
+	Uint64 component_bit = 1ll << component_type;
+
+	if(prefab->component_mask & component_bit)
+	{
+		SDL_Log("WARNING prefab alread has component type %d\n", component_type);
+		return;
+	}
+
+	prefab->component_mask |= component_bit;
+	prefab->component_data[component_type] = SDL_malloc(size);
+	SDL_memcpy(prefab->component_data[component_type], in_data_copy, size);
+}
+
+void itu_prefab_tag_add(ITU_Prefab* prefab, ITU_TagType tag)
+{
+	SDL_assert(tag < TAGS_COUNT_MAX);
+	prefab->tag_mask |= tag_mask(tag);
+}
+
+// NOTE: the created body id will be written in `PhysicsData` or `PhysicsStaticData` (whichever the prefab has),
+//       and the shape id in `ShapeData` (if the prefab has it)
+void itu_prefab_set_body(ITU_Prefab* prefab, b2BodyDef* body_def, b2ShapeDef* shape_def, ITU_PhysicsShape* shape)
+{
+	prefab->has_body  = true;
+	prefab->body_def  = *body_def;
+	prefab->shape_def = *shape_def;
+	prefab->shape     = *shape;
+}
+
+// creates `count` entities from the prefab, optionally placing them at `positions` (can be NULL)
+// `out_ids` must have space for at least `count` elements
+void itu_prefab_instantiate(ITU_Prefab* prefab, int count, vec2f* positions, ITU_EntityId* out_ids)
+{
+	if(count <= 0)
+		return;
+
+	itu_entity_create_batch(out_ids, count);
+
+	// copy component blobs column-wise (one contiguous block per component pool)
+	Transform*         data_transform      = NULL;
+	PhysicsData*       data_physics        = NULL;
+	PhysicsStaticData* data_physics_static = NULL;
+	ShapeData*         data_shape          = NULL;
+	for(int i = 0; i < COMPONENTS_COUNT_MAX; ++i)
+	{
+		if(!(prefab->component_mask & (1ll << i)))
+			continue;
+
+		void* column = itu_entity_component_add_batch(out_ids, count, i, prefab->component_data[i]);
+
+		if(i == component_type(Transform))         data_transform      = (Transform*)column;
+		if(i == component_type(PhysicsData))       data_physics        = (PhysicsData*)column;
+		if(i == component_type(PhysicsStaticData)) data_physics_static = (PhysicsStaticData*)column;
+		if(i == component_type(ShapeData))         data_shape          = (ShapeData*)column;
+	}
+
+	for(int i = 0; i < TAGS_COUNT_MAX; ++i)
+	{
+		if(!(prefab->tag_mask & tag_mask(i)))
+			continue;
+		for(int j = 0; j < count; ++j)
+			itu_entity_tag_add(out_ids[j], i);
+	}
+
+	// patch per-instance data
+	if(positions && data_transform)
+		for(int i = 0; i < count; ++i)
+			data_transform[i].position = positions[i];
+
+	if(prefab->has_body)
+	{
+		// NOTE: scratch arrays to keep the bulk creation independent from the components the prefab uses
+		b2BodyId*  body_ids  = (b2BodyId*) SDL_malloc(sizeof(b2BodyId)  * count);
+		b2ShapeId* shape_ids = (b2ShapeId*)SDL_malloc(sizeof(b2ShapeId) * count);
+
+		itu_sys_physics_add_bodies(out_ids, count, &prefab->body_def, &prefab->shape_def, &prefab->shape, positions, body_ids, shape_ids);
+
+		for(int i = 0; i < count; ++i)
+		{
+			if(data_physics)
+				data_physics[i].body_id = body_ids[i];
+			if(data_physics_static)
+				data_physics_static[i].body_id = body_ids[i];
+			if(data_shape)
+				data_shape[i].shape_id = shape_ids[i];
+		}
+
+		SDL_free(body_ids);
+		SDL_free(shape_ids);
+	}
+}
+
+#endif // (defined ITU_LIB_PREFAB_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
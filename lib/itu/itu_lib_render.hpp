@@ -1,24 +1,50 @@
 // itu_lib_renderer.hpp
 // simple library to render debug shapes
+// shapes are not drawn immediately, but accumulated in two vertex streams (fills and lines, where lines are
+// thin quads so that they can carry their own color) and submitted with a single `SDL_RenderGeometry` per stream.
+// - between `itu_lib_render_debug_begin()` and `itu_lib_render_debug_end()`, everything is submitted at `end`
+//   (pairs can be nested, only the outermost `end` submits)
+// - outside of it, each shape is submitted right away (still a single call per stream, but no batching across shapes)
+// shapes are assigned to the current debug layer (see `itu_lib_render_debug_set_layer()`). Layers are drawn in order,
+// and each can be toggled off, so that its shapes are discarded before doing any work
 // limitations
 // - no rotation
 // - only polygons have color fill
-// 
-// TODO
-// - get rid of VLAs
-// - get rid of BUFFER_SIZE
+// - lines are always 1 pixel wide (in render coordinates, so they still scale with render scale)
 
 #ifndef ITU_LIB_RENDER_HPP
 #define ITU_LIB_RENDER_HPP
 
 #ifndef ITU_UNITY_BUILD
 #include <SDL3/SDL_render.h>
+#include <stb_ds.h>
 #include <itu_common.hpp>
 #include <itu_lib_engine.hpp>
 #endif
 
 #define MAX_CIRCLE_VERTICES 16
 
+enum ITU_RenderDebugLayer
+{
+	ITU_RENDER_DEBUG_LAYER_DEFAULT,
+	ITU_RENDER_DEBUG_LAYER_TOP,     // drawn after the default layer (ie, highlights that should never be hidden by other debug shapes)
+	ITU_RENDER_DEBUG_LAYER_COUNT
+};
+
+struct ITU_RenderDebugStats
+{
+	int shapes_count;
+	int draw_calls;
+};
+
+void itu_lib_render_debug_begin();
+void itu_lib_render_debug_end(SDL_Renderer* renderer);
+void itu_lib_render_debug_set_layer(ITU_RenderDebugLayer layer);
+void itu_lib_render_debug_set_layer_enabled(ITU_RenderDebugLayer layer, bool enabled);
+bool itu_lib_render_debug_get_layer_enabled(ITU_RenderDebugLayer layer);
+ITU_RenderDebugStats itu_lib_render_debug_get_stats();
+const vec2f* itu_lib_render_get_unit_circle(int vertex_count);
+
 void itu_lib_render_draw_point(SDL_Renderer* renderer, vec2f pos, float half_size, color color);
 void itu_lib_render_draw_line(SDL_Renderer* renderer, vec2f p0, vec2f p1, color color);
 void itu_lib_render_draw_rect(SDL_Renderer* renderer, vec2f min, vec2f max, color color);
@@ -39,124 +65,394 @@ void itu_lib_render_draw_world_grid(SDLContext* context);
 
 #if defined ITU_LIB_RENDER_IMPLEMENTATION || defined ITU_UNITY_BUILD
 
+struct ITU_RenderDebugStream
+{
+	stbds_arr(SDL_Vertex) vertices;
+	stbds_arr(int)        indices;
+};
+
+struct ITU_RenderDebugLayerData
+{
+	ITU_RenderDebugStream fills;
+	ITU_RenderDebugStream lines;
+	bool disabled;
+};
+
+struct ITU_RenderDebugContext
+{
+	ITU_RenderDebugLayerData layers[ITU_RENDER_DEBUG_LAYER_COUNT];
+	ITU_RenderDebugLayer     layer_curr;
+	int                      batching_depth;
+
+	// unit circles, one for each vertex count (built the first time they are needed)
+	vec2f circle_tables[MAX_CIRCLE_VERTICES + 1][MAX_CIRCLE_VERTICES];
+	bool  circle_tables_ready[MAX_CIRCLE_VERTICES + 1];
+
+	ITU_RenderDebugStats stats;
+	ITU_RenderDebugStats stats_curr;
+};
+
+static ITU_RenderDebugContext ctx_render_debug;
+
+void itu_lib_render_debug_begin()
+{
+	if(ctx_render_debug.batching_depth == 0)
+		ctx_render_debug.stats_curr = { 0 };
+	ctx_render_debug.batching_depth++;
+}
+
+static void itu_lib_render_debug_submit(SDL_Renderer* renderer, ITU_RenderDebugStream* stream)
+{
+	if(stbds_arrlen(stream->indices) == 0)
+		return;
+
+	SDL_RenderGeometry(renderer, NULL, stream->vertices, stbds_arrlen(stream->vertices), stream->indices, stbds_arrlen(stream->indices));
+	ctx_render_debug.stats_curr.draw_calls++;
+
+	// NOTE: buffers are kept across frames, so that they only grow during the first few frames
+	stbds_arrsetlen(stream->vertices, 0);
+	stbds_arrsetlen(stream->indices, 0);
+}
+
+static void itu_lib_render_debug_flush(SDL_Renderer* renderer)
+{
+	for(int i = 0; i < ITU_RENDER_DEBUG_LAYER_COUNT; ++i)
+	{
+		itu_lib_render_debug_submit(renderer, &ctx_render_debug.layers[i].fills);
+		itu_lib_render_debug_submit(renderer, &ctx_render_debug.layers[i].lines);
+	}
+}
+
+// submits everything accumulated since `itu_lib_render_debug_begin()`
+void itu_lib_render_debug_end(SDL_Renderer* renderer)
+{
+	SDL_assert(ctx_render_debug.batching_depth > 0);
+	ctx_render_debug.batching_depth--;
+	if(ctx_render_debug.batching_depth > 0)
+		return;
+
+	itu_lib_render_debug_flush(renderer);
+	ctx_render_debug.stats = ctx_render_debug.stats_curr;
+}
+
+void itu_lib_render_debug_set_layer(ITU_RenderDebugLayer layer)
+{
+	SDL_assert(layer < ITU_RENDER_DEBUG_LAYER_COUNT);
+	ctx_render_debug.layer_curr = layer;
+}
+
+void itu_lib_render_debug_set_layer_enabled(ITU_RenderDebugLayer layer, bool enabled)
+{
+	SDL_assert(layer < ITU_RENDER_DEBUG_LAYER_COUNT);
+	ctx_render_debug.layers[layer].disabled = !enabled;
+}
+
+bool itu_lib_render_debug_get_layer_enabled(ITU_RenderDebugLayer layer)
+{
+	SDL_assert(layer < ITU_RENDER_DEBUG_LAYER_COUNT);
+	return !ctx_render_debug.layers[layer].disabled;
+}
+
+// stats of the last `itu_lib_render_debug_begin()`/`itu_lib_render_debug_end()` pair
+ITU_RenderDebugStats itu_lib_render_debug_get_stats()
+{
+	return ctx_render_debug.stats;
+}
+
+// returns the layer new shapes should be added to, or NULL if it is disabled (ie, the shape should be skipped)
+static ITU_RenderDebugLayerData* itu_lib_render_debug_shape_begin()
+{
+	ITU_RenderDebugLayerData* layer = &ctx_render_debug.layers[ctx_render_debug.layer_curr];
+	if(layer->disabled)
+		return NULL;
+
+	ctx_render_debug.stats_curr.shapes_count++;
+	return layer;
+}
+
+// outside of begin/end, shapes are submitted as soon as they are complete
+static void itu_lib_render_debug_shape_end(SDL_Renderer* renderer)
+{
+	if(ctx_render_debug.batching_depth == 0)
+		itu_lib_render_debug_flush(renderer);
+}
+
+static void itu_lib_render_debug_push_line(ITU_RenderDebugLayerData* layer, float x0, float y0, float x1, float y1, SDL_FColor c)
+{
+	// half-pixel offset along the normal, so that the quad is 1 pixel wide
+	float dx = x1 - x0;
+	float dy = y1 - y0;
+	float len_sq = dx * dx + dy * dy;
+	float nx = 0.5f;
+	float ny = 0;
+	if(len_sq > 0)
+	{
+		float len_inv = 0.5f / SDL_sqrtf(len_sq);
+		nx = -dy * len_inv;
+		ny =  dx * len_inv;
+	}
+
+	ITU_RenderDebugStream* stream = &layer->lines;
+	int first = stbds_arrlen(stream->vertices);
+	SDL_Vertex* vs = stbds_arraddnptr(stream->vertices, 4);
+	vs[0].position = SDL_FPoint{ x0 + nx, y0 + ny };
+	vs[1].position = SDL_FPoint{ x1 + nx, y1 + ny };
+	vs[2].position = SDL_FPoint{ x1 - nx, y1 - ny };
+	vs[3].position = SDL_FPoint{ x0 - nx, y0 - ny };
+	for(int i = 0; i < 4; ++i)
+	{
+		vs[i].color = c;
+		vs[i].tex_coord = SDL_FPoint{ 0, 0 };
+	}
+
+	int* is = stbds_arraddnptr(stream->indices, 6);
+	is[0] = first + 0;
+	is[1] = first + 1;
+	is[2] = first + 2;
+	is[3] = first + 0;
+	is[4] = first + 2;
+	is[5] = first + 3;
+}
+
+// adds a closed outline through the given points
+static void itu_lib_render_debug_push_outline(ITU_RenderDebugLayerData* layer, const SDL_FPoint* points, int count, SDL_FColor c)
+{
+	for(int i = 0; i < count; ++i)
+	{
+		SDL_FPoint p0 = points[i];
+		SDL_FPoint p1 = points[(i + 1) % count];
+		itu_lib_render_debug_push_line(layer, p0.x, p0.y, p1.x, p1.y, c);
+	}
+}
+
+// adds a convex polygon, as a triangle fan
+static void itu_lib_render_debug_push_fill(ITU_RenderDebugLayerData* layer, const SDL_FPoint* points, int count, SDL_FColor c)
+{
+	ITU_RenderDebugStream* stream = &layer->fills;
+	int first = stbds_arrlen(stream->vertices);
+	SDL_Vertex* vs = stbds_arraddnptr(stream->vertices, count);
+	for(int i = 0; i < count; ++i)
+	{
+		vs[i].position = points[i];
+		vs[i].color = c;
+		vs[i].tex_coord = SDL_FPoint{ 0, 0 };
+	}
+
+	int* is = stbds_arraddnptr(stream->indices, (count - 2) * 3);
+	for(int i = 2; i < count; ++i)
+	{
+		*is++ = first;
+		*is++ = first + i - 1;
+		*is++ = first + i;
+	}
+}
+
+// returns `vertex_count` points evenly spaced on the unit circle (counter-clockwise, starting from (1, 0))
+const vec2f* itu_lib_render_get_unit_circle(int vertex_count)
+{
+	SDL_assert(vertex_count >= 3 && vertex_count <= MAX_CIRCLE_VERTICES);
+
+	vec2f* table = ctx_render_debug.circle_tables[vertex_count];
+	if(!ctx_render_debug.circle_tables_ready[vertex_count])
+	{
+		float angle_increment = TAU / vertex_count;
+		for(int i = 0; i < vertex_count; ++i)
+		{
+			table[i].x = SDL_cosf(angle_increment * i);
+			table[i].y = SDL_sinf(angle_increment * i);
+		}
+		ctx_render_debug.circle_tables_ready[vertex_count] = true;
+	}
+	return table;
+}
+
 void itu_lib_render_draw_point(SDL_Renderer* renderer, vec2f pos, float half_size, color color)
 {
-	//itu_lib_render_draw_rect(renderer, pos - vec2f { size / 2, size / 2}, vec2f { size, size }, color);
-	SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b,color.a);
-	SDL_RenderLine(renderer, pos.x - half_size, pos.y, pos.x + half_size, pos.y);
-	SDL_RenderLine(renderer, pos.x, pos.y - half_size, pos.x, pos.y + half_size);
+	ITU_RenderDebugLayerData* layer = itu_lib_render_debug_shape_begin();
+	if(!layer)
+		return;
+
+	SDL_FColor c = { color.r, color.g, color.b, color.a };
+	itu_lib_render_debug_push_line(layer, pos.x - half_size, pos.y, pos.x + half_size, pos.y, c);
+	itu_lib_render_debug_push_line(layer, pos.x, pos.y - half_size, pos.x, pos.y + half_size, c);
+
+	itu_lib_render_debug_shape_end(renderer);
 }
 
 void itu_lib_render_draw_line(SDL_Renderer* renderer, vec2f p0, vec2f p1, color color)
 {
-	SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b,color.a);
-	SDL_RenderLine(renderer, p0.x, p0.y, p1.x, p1.y);
+	ITU_RenderDebugLayerData* layer = itu_lib_render_debug_shape_begin();
+	if(!layer)
+		return;
+
+	SDL_FColor c = { color.r, color.g, color.b, color.a };
+	itu_lib_render_debug_push_line(layer, p0.x, p0.y, p1.x, p1.y, c);
+
+	itu_lib_render_debug_shape_end(renderer);
 }
 
 void itu_lib_render_draw_rect(SDL_Renderer* renderer, vec2f min, vec2f extents, color color)
 {
-	SDL_FRect rect;
-	rect.x = min.x;
-	rect.y = min.y;
-	rect.w = extents.x;
-	rect.h = extents.y;
-
-	SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
-	SDL_RenderRect(renderer, &rect);
+	ITU_RenderDebugLayerData* layer = itu_lib_render_debug_shape_begin();
+	if(!layer)
+		return;
+
+	SDL_FColor c = { color.r, color.g, color.b, color.a };
+	SDL_FPoint points[4] = {
+		{ min.x            , min.y             },
+		{ min.x + extents.x, min.y             },
+		{ min.x + extents.x, min.y + extents.y },
+		{ min.x            , min.y + extents.y },
+	};
+	itu_lib_render_debug_push_outline(layer, points, 4, c);
+
+	itu_lib_render_debug_shape_end(renderer);
 }
 
 void itu_lib_render_draw_rect_fill(SDL_Renderer* renderer, vec2f min, vec2f extents, color color)
 {
-	SDL_FRect rect;
-	rect.x = min.x;
-	rect.y = min.y;
-	rect.w = extents.x;
-	rect.h = extents.y;
-
-	SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
-	SDL_RenderFillRect(renderer, &rect);
+	ITU_RenderDebugLayerData* layer = itu_lib_render_debug_shape_begin();
+	if(!layer)
+		return;
+
+	SDL_FColor c = { color.r, color.g, color.b, color.a };
+	SDL_FPoint points[4] = {
+		{ min.x            , min.y             },
+		{ min.x + extents.x, min.y             },
+		{ min.x + extents.x, min.y + extents.y },
+		{ min.x            , min.y + extents.y },
+	};
+	itu_lib_render_debug_push_fill(layer, points, 4, c);
+
+	itu_lib_render_debug_shape_end(renderer);
 }
 
 // NOTE: vertex count must be smaller than `MAX_CIRCLE_VERTICES` (defaults to 16, but you can change it if you need to)
 void itu_lib_render_draw_circle(SDL_Renderer* renderer, vec2f center, float radius, int vertex_count, color color)
 {
-	SDL_assert(vertex_count <= MAX_CIRCLE_VERTICES);
+	SDL_assert(vertex_count >= 3 && vertex_count <= MAX_CIRCLE_VERTICES);
 
-	SDL_FPoint points[MAX_CIRCLE_VERTICES + 1];
-	
-	float angle_increment = TAU / vertex_count;
+	ITU_RenderDebugLayerData* layer = itu_lib_render_debug_shape_begin();
+	if(!layer)
+		return;
 
-	// very slow, a lot of trig
-	// we could also do a single quadrant and mirror the rest
+	// no trig here, the unit circle is computed once per vertex count
+	const vec2f* table = itu_lib_render_get_unit_circle(vertex_count);
+	SDL_FPoint points[MAX_CIRCLE_VERTICES];
 	for(int i = 0; i < vertex_count; ++i)
 	{
-		float angle = angle_increment * i;
-		float px = radius * SDL_cos(angle);
-		float py = radius * SDL_sin(angle);
-		// 1st quadrant
-		points[i].x = center.x + px;
-		points[i].y = center.y + py;
+		points[i].x = center.x + radius * table[i].x;
+		points[i].y = center.y + radius * table[i].y;
 	}
-	points[vertex_count] = points[0];
-	
-	SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, 0xFF);
-	SDL_RenderLines(renderer, points, vertex_count + 1);
+
+	SDL_FColor c = { color.r, color.g, color.b, 1.0f };
+	itu_lib_render_debug_push_outline(layer, points, vertex_count, c);
+
+	itu_lib_render_debug_shape_end(renderer);
 }
 
+// NOTE: polygon must be convex
 void itu_lib_render_draw_polygon(SDL_Renderer* renderer, vec2f position, const vec2f* vertices, int vertexCount, color color)
 {
-#define BUFFER_SIZE 128 + 1
-	SDL_FColor color_fill = { color.r, color.g, color.b, color.a };
+	if(vertexCount < 3)
+		return;
 
-	SDL_FPoint vs_outline[BUFFER_SIZE];
-	SDL_Vertex vs[BUFFER_SIZE];
-	SDL_zeroa(vs);
-	
+	ITU_RenderDebugLayerData* layer = itu_lib_render_debug_shape_begin();
+	if(!layer)
+		return;
+
+	SDL_FColor color_fill    = { color.r, color.g, color.b, color.a };
+	SDL_FColor color_outline = { color.r, color.g, color.b, 1.0f };
+
+	// fill (triangle fan)
+	ITU_RenderDebugStream* fills = &layer->fills;
+	int first = stbds_arrlen(fills->vertices);
+	SDL_Vertex* vs = stbds_arraddnptr(fills->vertices, vertexCount);
 	for (int i = 0; i < vertexCount; ++i)
 	{
-		vec2f pos = position + vertices[i];
-
+		vs[i].position.x = position.x + vertices[i].x;
+		vs[i].position.y = position.y + vertices[i].y;
 		vs[i].color = color_fill;
-		vs[i].position.x = pos.x;
-		vs[i].position.y = pos.y;
-		vs[i].tex_coord.x = 0;
-		vs[i].tex_coord.y = 0;
-		vs_outline[i].x = vs[i].position.x;
-		vs_outline[i].y = vs[i].position.y;
+		vs[i].tex_coord = SDL_FPoint{ 0, 0 };
 	}
-	vs_outline[vertexCount].x = vs_outline[0].x;
-	vs_outline[vertexCount].y = vs_outline[0].y;
 
-	int indices_count = (vertexCount - 2)*3;
-	int indices[BUFFER_SIZE];
-	int c = 0;
+	int* is = stbds_arraddnptr(fills->indices, (vertexCount - 2) * 3);
 	for (int i = 2; i < vertexCount; ++i)
 	{
-		indices[c++] = 0;
-		indices[c++] = i - 1;
-		indices[c++] = i;
+		*is++ = first;
+		*is++ = first + i - 1;
+		*is++ = first + i;
 	}
 
-	SDL_RenderGeometry(renderer, NULL, vs, vertexCount, indices, indices_count);
-	
-	SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, 1.0f);
-	SDL_RenderLines(renderer, vs_outline, vertexCount + 1);
+	// outline (reusing the positions we just computed)
+	for (int i = 0; i < vertexCount; ++i)
+	{
+		SDL_FPoint p0 = vs[i].position;
+		SDL_FPoint p1 = vs[(i + 1) % vertexCount].position;
+		itu_lib_render_debug_push_line(layer, p0.x, p0.y, p1.x, p1.y, color_outline);
+	}
+
+	itu_lib_render_debug_shape_end(renderer);
+}
+
+// returns false if the given world-space AABB is completely outside the active camera
+// NOTE: used to skip conversion and draw calls for debug primitives that would end up offscreen anyway
+static bool itu_lib_render_is_visible(SDLContext* context, vec2f min, vec2f max)
+{
+	SDL_FRect view = camera_get_world_rect(context, context->camera_active);
+	return min.x <= view.x + view.w && max.x >= view.x && min.y <= view.y + view.h && max.y >= view.y;
 }
 
 void itu_lib_render_draw_world_point(SDLContext* context, vec2f pos, float half_size, color color)
 {
+	if(!itu_lib_render_is_visible(context, pos, pos))
+		return;
 	itu_lib_render_draw_point(context->renderer, point_global_to_screen(context, pos), half_size, color);
 }
 
 void itu_lib_render_draw_world_line(SDLContext* context, vec2f p0, vec2f p1, color color)
 {
+	vec2f min = { SDL_min(p0.x, p1.x), SDL_min(p0.y, p1.y) };
+	vec2f max = { SDL_max(p0.x, p1.x), SDL_max(p0.y, p1.y) };
+	if(!itu_lib_render_is_visible(context, min, max))
+		return;
 	itu_lib_render_draw_line(context->renderer, point_global_to_screen(context, p0), point_global_to_screen(context, p1), color);
 }
 
-void itu_lib_render_draw_world_rect(SDLContext* context, vec2f min, vec2f max, color color);
-void itu_lib_render_draw_world_rect_fill(SDLContext* context, vec2f min, vec2f max, color color);
+// converts a world-space AABB to the screen-space min/extents used by the rect draws
+// NOTE: the camera can flip axes (ie, y up in world space), so corners are sorted again after the conversion
+static void itu_lib_render_rect_global_to_screen(SDLContext* context, vec2f min, vec2f max, vec2f* out_min, vec2f* out_extents)
+{
+	vec2f p0 = point_global_to_screen(context, min);
+	vec2f p1 = point_global_to_screen(context, max);
+	out_min->x = SDL_min(p0.x, p1.x);
+	out_min->y = SDL_min(p0.y, p1.y);
+	out_extents->x = SDL_fabsf(p1.x - p0.x);
+	out_extents->y = SDL_fabsf(p1.y - p0.y);
+}
+
+void itu_lib_render_draw_world_rect(SDLContext* context, vec2f min, vec2f max, color color)
+{
+	if(!itu_lib_render_is_visible(context, min, max))
+		return;
+	vec2f screen_min, screen_extents;
+	itu_lib_render_rect_global_to_screen(context, min, max, &screen_min, &screen_extents);
+	itu_lib_render_draw_rect(context->renderer, screen_min, screen_extents, color);
+}
+
+void itu_lib_render_draw_world_rect_fill(SDLContext* context, vec2f min, vec2f max, color color)
+{
+	if(!itu_lib_render_is_visible(context, min, max))
+		return;
+	vec2f screen_min, screen_extents;
+	itu_lib_render_rect_global_to_screen(context, min, max, &screen_min, &screen_extents);
+	itu_lib_render_draw_rect_fill(context->renderer, screen_min, screen_extents, color);
+}
+
 void itu_lib_render_draw_world_circle(SDLContext* context, vec2f center, float radius, int vertex_count, color c)
 {
+	if(!itu_lib_render_is_visible(context, center - radius, center + radius))
+		return;
 	itu_lib_render_draw_circle(context->renderer, point_global_to_screen(context, center), size_global_to_screen(context, radius), vertex_count, c);
 }
 
@@ -0,0 +1,459 @@
+// itu_lib_render_queue.hpp
+// deferred renderer: everything that needs to be drawn is pushed in the queue together with a 64bit sort key,
+// and at the end of the frame the queue is sorted (radix sort, linear in the number of items) and submitted.
+// Contiguous textured quads sharing the same texture are submitted with a single `SDL_RenderGeometry` call
+//
+// sort key layout (from most to least significant bits)
+// - layer    ( 8 bits) lower layers are drawn first
+// - texture  (16 bits) small id assigned to each texture the first time it is seen
+// - depth    (24 bits) screen-space y, items lower on screen are drawn later
+// - sequence (16 bits) submission order inside the frame (saturates, but the sort is stable anyway)
+// layers can be switched to y-sorting with `itu_lib_render_queue_set_layer_ysort()`, which swaps texture and depth.
+// This gives correct overlaps for top-down games, at the cost of smaller batches
+//
+// anything that can't be expressed as a textured quad (text, 9-patches, debug primitives, ...) can be pushed
+// as a callback, with its data copied in the frame arena
+//
+// layers that rarely change (ie, UI) can be cached with `itu_lib_render_queue_set_layer_cached()`: their items are
+// rendered into a texture the size of the current viewport, and then the texture is drawn with a single quad.
+// The texture is redrawn only after the layer is invalidated with `itu_lib_render_queue_invalidate_layer()`,
+// otherwise everything pushed to the layer is simply discarded
+//
+// limitations
+// - quads are converted to screen space when pushed, so the camera must not change before the queue is flushed
+// - callbacks break batches (they are still sorted correctly)
+// - cached layers store screen-space pixels, so they only make sense for things that don't follow the camera
+
+#ifndef ITU_LIB_RENDER_QUEUE_HPP
+#define ITU_LIB_RENDER_QUEUE_HPP
+
+#ifndef ITU_UNITY_BUILD
+#include <SDL3/SDL.h>
+#include <stb_ds.h>
+#include <itu_common.hpp>
+#include <itu_lib_engine.hpp>
+#include <itu_lib_arena.hpp>
+#endif
+
+#define RENDER_QUEUE_LAYERS_MAX 256
+
+typedef void (*ITU_RenderQueueCallback)(SDLContext* context, void* data);
+
+struct ITU_RenderQueueStats
+{
+	int items_count;
+	int draw_calls;
+	int cached_layers_redrawn;
+};
+
+void itu_lib_render_queue_push_quad(Uint8 layer, float depth, SDL_Texture* texture, SDL_Vertex* vertices);
+void itu_lib_render_queue_push_callback(Uint8 layer, float depth, SDL_Texture* texture, ITU_RenderQueueCallback fn_render, void* in_data_copy, Uint64 data_size);
+void itu_lib_render_queue_set_layer_ysort(Uint8 layer, bool enabled);
+void itu_lib_render_queue_set_layer_cached(Uint8 layer, bool enabled);
+void itu_lib_render_queue_invalidate_layer(Uint8 layer);
+bool itu_lib_render_queue_layer_needs_redraw(Uint8 layer);
+void itu_lib_render_queue_flush(SDLContext* context);
+
+ITU_RenderQueueStats itu_lib_render_queue_get_stats();
+
+#endif // ITU_LIB_RENDER_QUEUE_HPP
+
+#if (defined ITU_LIB_RENDER_QUEUE_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
+
+struct ITU_RenderQueueItem
+{
+	SDL_Texture* texture;
+	ITU_RenderQueueCallback fn_render; // NULL for quads
+	union
+	{
+		int   vertex_first; // quads
+		void* data;         // callbacks
+	};
+};
+
+struct ITU_RenderQueueSortEntry
+{
+	Uint64 key;
+	Uint64 item;
+};
+
+struct ITU_RenderQueueCachedLayer
+{
+	SDL_Texture* texture;
+	SDL_Texture* target_prev; // render target to restore after the layer is redrawn
+	bool enabled;
+	bool dirty;
+	bool redraw_started;      // begin marker already pushed this frame
+};
+
+struct ITU_RenderQueueContext
+{
+	stbds_arr(ITU_RenderQueueItem)      items;
+	stbds_arr(ITU_RenderQueueSortEntry) keys;
+	stbds_arr(SDL_Vertex)               vertices;
+	Uint32 sequence;
+
+	stbds_hm(SDL_Texture*, Uint16) texture_ids;
+	Uint16 texture_ids_next;
+
+	bool layer_ysort[RENDER_QUEUE_LAYERS_MAX];
+	ITU_RenderQueueCachedLayer cached_layers[RENDER_QUEUE_LAYERS_MAX];
+
+	ITU_RenderQueueStats stats;
+};
+
+static ITU_RenderQueueContext ctx_render_queue;
+
+static Uint64 itu_lib_render_queue_make_key(Uint8 layer, float depth, SDL_Texture* texture)
+{
+	// texture id 0 is reserved for callbacks that don't use any texture
+	Uint64 texture_id = 0;
+	if(texture)
+	{
+		int loc = stbds_hmgeti(ctx_render_queue.texture_ids, texture);
+		if(loc != -1)
+			texture_id = ctx_render_queue.texture_ids[loc].value;
+		else
+		{
+			// NOTE: after 65535 textures all new ones share the last id. They will still be sorted correctly, just batched less
+			if(ctx_render_queue.texture_ids_next < 0xFFFF)
+				ctx_render_queue.texture_ids_next++;
+			texture_id = ctx_render_queue.texture_ids_next;
+			stbds_hmput(ctx_render_queue.texture_ids, texture, (Uint16)texture_id);
+		}
+	}
+
+	// quarter-pixel precision, centered so that slightly negative positions (sprites partially offscreen) still sort correctly
+	Uint64 depth_bits = (Uint64)SDL_clamp(depth * 4.0f + (float)(1 << 23), 0.0f, (float)0xFFFFFF);
+
+	Uint64 sequence = SDL_min(ctx_render_queue.sequence, 0xFFFF);
+	ctx_render_queue.sequence++;
+
+	if(ctx_render_queue.layer_ysort[layer])
+		return ((Uint64)layer << 56) | (depth_bits << 32) | (texture_id << 16) | sequence;
+	return ((Uint64)layer << 56) | (texture_id << 40) | (depth_bits << 16) | sequence;
+}
+
+static void itu_lib_render_queue_push_marker(Uint64 key, ITU_RenderQueueCallback fn_render, void* data)
+{
+	ITU_RenderQueueItem item;
+	item.texture = NULL;
+	item.fn_render = fn_render;
+	item.data = data;
+
+	ITU_RenderQueueSortEntry entry;
+	entry.key = key;
+	entry.item = stbds_arrlen(ctx_render_queue.items);
+
+	stbds_arrput(ctx_render_queue.items, item);
+	stbds_arrput(ctx_render_queue.keys, entry);
+}
+
+// redirects the rest of the layer to its cached texture (recreating it if the viewport size changed)
+static void itu_lib_render_queue_cached_layer_begin(SDLContext* context, void* data)
+{
+	ITU_RenderQueueCachedLayer* cached = (ITU_RenderQueueCachedLayer*)data;
+
+	SDL_Rect viewport;
+	SDL_GetRenderViewport(context->renderer, &viewport);
+
+	if(cached->texture && (cached->texture->w != viewport.w || cached->texture->h != viewport.h))
+	{
+		SDL_DestroyTexture(cached->texture);
+		cached->texture = NULL;
+	}
+	if(!cached->texture)
+	{
+		cached->texture = SDL_CreateTexture(context->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, viewport.w, viewport.h);
+		if(!cached->texture)
+		{
+			SDL_Log("WARNING can't create cached layer texture: %s\n", SDL_GetError());
+			return;
+		}
+		// layer is drawn with regular alpha blending on a transparent texture, so its content ends up premultiplied
+		SDL_SetTextureBlendMode(cached->texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+		SDL_SetTextureScaleMode(cached->texture, SDL_SCALEMODE_NEAREST);
+	}
+
+	cached->target_prev = SDL_GetRenderTarget(context->renderer);
+	SDL_SetRenderTarget(context->renderer, cached->texture);
+	SDL_SetRenderDrawColor(context->renderer, 0x00, 0x00, 0x00, 0x00);
+	SDL_RenderClear(context->renderer);
+}
+
+// restores the original render target (if the layer was redrawn), and draws the cached texture
+static void itu_lib_render_queue_cached_layer_end(SDLContext* context, void* data)
+{
+	ITU_RenderQueueCachedLayer* cached = (ITU_RenderQueueCachedLayer*)data;
+	if(!cached->texture)
+		return;
+
+	if(cached->redraw_started)
+		SDL_SetRenderTarget(context->renderer, cached->target_prev);
+
+	SDL_FRect rect_dst = { 0, 0, (float)cached->texture->w, (float)cached->texture->h };
+	sdl_set_texture_tint(cached->texture, COLOR_WHITE);
+	SDL_RenderTexture(context->renderer, cached->texture, NULL, &rect_dst);
+}
+
+// returns false if the item must be discarded (cached layer that doesn't need to be redrawn)
+static bool itu_lib_render_queue_prepare_layer(Uint8 layer)
+{
+	ITU_RenderQueueCachedLayer* cached = &ctx_render_queue.cached_layers[layer];
+	if(!cached->enabled)
+		return true;
+	if(!cached->dirty)
+		return false;
+
+	// pushed before any other item of the layer, so (stable) sorting will keep it first
+	if(!cached->redraw_started)
+	{
+		itu_lib_render_queue_push_marker((Uint64)layer << 56, itu_lib_render_queue_cached_layer_begin, cached);
+		cached->redraw_started = true;
+	}
+	return true;
+}
+
+// `vertices` must hold 4 vertices, in clockwise or counter-clockwise order
+void itu_lib_render_queue_push_quad(Uint8 layer, float depth, SDL_Texture* texture, SDL_Vertex* vertices)
+{
+	if(!itu_lib_render_queue_prepare_layer(layer))
+		return;
+
+	ITU_RenderQueueItem item;
+	item.texture = texture;
+	item.fn_render = NULL;
+	item.vertex_first = stbds_arrlen(ctx_render_queue.vertices);
+
+	SDL_Vertex* dst = stbds_arraddnptr(ctx_render_queue.vertices, 4);
+	SDL_memcpy(dst, vertices, sizeof(SDL_Vertex) * 4);
+
+	ITU_RenderQueueSortEntry entry;
+	entry.key = itu_lib_render_queue_make_key(layer, depth, texture);
+	entry.item = stbds_arrlen(ctx_render_queue.items);
+
+	stbds_arrput(ctx_render_queue.items, item);
+	stbds_arrput(ctx_render_queue.keys, entry);
+}
+
+// `texture` is only used for sorting (it can be NULL)
+void itu_lib_render_queue_push_callback(Uint8 layer, float depth, SDL_Texture* texture, ITU_RenderQueueCallback fn_render, void* in_data_copy, Uint64 data_size)
+{
+	if(!itu_lib_render_queue_prepare_layer(layer))
+		return;
+
+	ITU_RenderQueueItem item;
+	item.texture = texture;
+	item.fn_render = fn_render;
+	item.data = NULL;
+	if(data_size > 0)
+	{
+		item.data = itu_lib_arena_alloc(itu_lib_arena_frame(), data_size, 16);
+		if(!item.data)
+			return;
+		SDL_memcpy(item.data, in_data_copy, data_size);
+	}
+
+	ITU_RenderQueueSortEntry entry;
+	entry.key = itu_lib_render_queue_make_key(layer, depth, texture);
+	entry.item = stbds_arrlen(ctx_render_queue.items);
+
+	stbds_arrput(ctx_render_queue.items, item);
+	stbds_arrput(ctx_render_queue.keys, entry);
+}
+
+void itu_lib_render_queue_set_layer_ysort(Uint8 layer, bool enabled)
+{
+	ctx_render_queue.layer_ysort[layer] = enabled;
+}
+
+// NOTE: newly cached layers are redrawn on their first frame
+void itu_lib_render_queue_set_layer_cached(Uint8 layer, bool enabled)
+{
+	ITU_RenderQueueCachedLayer* cached = &ctx_render_queue.cached_layers[layer];
+	if(!enabled && cached->texture)
+	{
+		SDL_DestroyTexture(cached->texture);
+		cached->texture = NULL;
+	}
+	cached->enabled = enabled;
+	cached->dirty = true;
+}
+
+// cached layer will be redrawn this frame
+// NOTE: invalidate before pushing the layer content, anything pushed earlier in the frame is already discarded
+void itu_lib_render_queue_invalidate_layer(Uint8 layer)
+{
+	ctx_render_queue.cached_layers[layer].dirty = true;
+}
+
+// returns false for cached layers that are not going to be redrawn this frame (so that their content doesn't need to be pushed at all)
+bool itu_lib_render_queue_layer_needs_redraw(Uint8 layer)
+{
+	ITU_RenderQueueCachedLayer* cached = &ctx_render_queue.cached_layers[layer];
+	return !cached->enabled || cached->dirty;
+}
+
+// LSD radix sort, 8 bits per pass
+// NOTE: all histograms are built in a single pass, and passes where all keys share the same byte are skipped
+//       (very common, since most frames only use a handful of layers and textures)
+static ITU_RenderQueueSortEntry* itu_lib_render_queue_sort(ITU_RenderQueueSortEntry* entries, int count)
+{
+	ITU_RenderQueueSortEntry* tmp = arena_push_array(itu_lib_arena_frame(), ITU_RenderQueueSortEntry, count);
+	if(!tmp)
+	{
+		// out of scratch memory, fallback to slower (but still stable) sort
+		SDL_Log("WARNING render queue falling back to insertion sort\n");
+		for(int i = 1; i < count; ++i)
+		{
+			ITU_RenderQueueSortEntry entry = entries[i];
+			int j = i - 1;
+			for(; j >= 0 && entries[j].key > entry.key; --j)
+				entries[j + 1] = entries[j];
+			entries[j + 1] = entry;
+		}
+		return entries;
+	}
+
+	int histograms[8][256];
+	SDL_zeroa(histograms);
+	for(int i = 0; i < count; ++i)
+	{
+		Uint64 key = entries[i].key;
+		for(int pass = 0; pass < 8; ++pass)
+			histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+	}
+
+	ITU_RenderQueueSortEntry* src = entries;
+	ITU_RenderQueueSortEntry* dst = tmp;
+	for(int pass = 0; pass < 8; ++pass)
+	{
+		int* histogram = histograms[pass];
+		Uint8 first_byte = (src[0].key >> (pass * 8)) & 0xFF;
+		if(histogram[first_byte] == count)
+			continue;
+
+		// exclusive prefix sum
+		int offset = 0;
+		for(int i = 0; i < 256; ++i)
+		{
+			int c = histogram[i];
+			histogram[i] = offset;
+			offset += c;
+		}
+
+		for(int i = 0; i < count; ++i)
+			dst[histogram[(src[i].key >> (pass * 8)) & 0xFF]++] = src[i];
+
+		ITU_RenderQueueSortEntry* swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	return src;
+}
+
+// sorts and submits everything pushed since last flush
+// NOTE: called by `itu_sys_estorage_systems_update()` after all systems are run, call it manually if you are not using the entity storage
+void itu_lib_render_queue_flush(SDLContext* context)
+{
+	// every cached layer needs to be drawn, even if nothing was pushed to it this frame
+	ctx_render_queue.stats.cached_layers_redrawn = 0;
+	for(int i = 0; i < RENDER_QUEUE_LAYERS_MAX; ++i)
+	{
+		ITU_RenderQueueCachedLayer* cached = &ctx_render_queue.cached_layers[i];
+		if(!cached->enabled)
+			continue;
+
+		// dirty layers with no content still need to be cleared
+		if(cached->dirty)
+		{
+			itu_lib_render_queue_prepare_layer((Uint8)i);
+			ctx_render_queue.stats.cached_layers_redrawn++;
+		}
+		itu_lib_render_queue_push_marker(((Uint64)i << 56) | 0x00FFFFFFFFFFFFFF, itu_lib_render_queue_cached_layer_end, cached);
+	}
+
+	int count = stbds_arrlen(ctx_render_queue.keys);
+	ctx_render_queue.stats.items_count = count;
+	ctx_render_queue.stats.draw_calls = 0;
+	if(count == 0)
+		return;
+
+	ITU_RenderQueueSortEntry* sorted = itu_lib_render_queue_sort(ctx_render_queue.keys, count);
+
+	// indices of each run are built in the same scratch buffer, one run after the other
+	int* indices = arena_push_array(itu_lib_arena_frame(), int, count * 6);
+	int indices_count = 0;
+	int run_first = 0;
+	SDL_Texture* run_texture = NULL;
+
+	SDL_Vertex* vertices = ctx_render_queue.vertices;
+	int vertices_count = stbds_arrlen(ctx_render_queue.vertices);
+
+	for(int i = 0; i <= count; ++i)
+	{
+		ITU_RenderQueueItem* item = i < count ? &ctx_render_queue.items[sorted[i].item] : NULL;
+		bool run_continues = item && !item->fn_render && item->texture == run_texture;
+
+		if(!run_continues && indices_count > run_first)
+		{
+			// texture color mod is multiplied with vertex colors, so we need to clear any tint left by non-queued rendering
+			if(run_texture)
+				sdl_set_texture_tint(run_texture, COLOR_WHITE);
+			SDL_RenderGeometry(context->renderer, run_texture, vertices, vertices_count, indices + run_first, indices_count - run_first);
+			ctx_render_queue.stats.draw_calls++;
+			run_first = indices_count;
+		}
+
+		if(!item)
+			break;
+
+		if(item->fn_render)
+		{
+			item->fn_render(context, item->data);
+			ctx_render_queue.stats.draw_calls++;
+			continue;
+		}
+
+		if(!indices)
+		{
+			// out of scratch memory, draw quads one by one
+			int quad_indices[6] = { 0, 1, 2, 0, 2, 3 };
+			if(item->texture)
+				sdl_set_texture_tint(item->texture, COLOR_WHITE);
+			SDL_RenderGeometry(context->renderer, item->texture, vertices + item->vertex_first, 4, quad_indices, 6);
+			ctx_render_queue.stats.draw_calls++;
+			continue;
+		}
+
+		run_texture = item->texture;
+		int v = item->vertex_first;
+		indices[indices_count++] = v + 0;
+		indices[indices_count++] = v + 1;
+		indices[indices_count++] = v + 2;
+		indices[indices_count++] = v + 0;
+		indices[indices_count++] = v + 2;
+		indices[indices_count++] = v + 3;
+	}
+
+	stbds_arrsetlen(ctx_render_queue.items, 0);
+	stbds_arrsetlen(ctx_render_queue.keys, 0);
+	stbds_arrsetlen(ctx_render_queue.vertices, 0);
+	ctx_render_queue.sequence = 0;
+
+	for(int i = 0; i < RENDER_QUEUE_LAYERS_MAX; ++i)
+	{
+		// NOTE: if the texture couldn't be created we keep trying
+		ITU_RenderQueueCachedLayer* cached = &ctx_render_queue.cached_layers[i];
+		cached->dirty = cached->enabled && !cached->texture;
+		cached->redraw_started = false;
+	}
+}
+
+ITU_RenderQueueStats itu_lib_render_queue_get_stats()
+{
+	return ctx_render_queue.stats;
+}
+
+#endif // (defined ITU_LIB_RENDER_QUEUE_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
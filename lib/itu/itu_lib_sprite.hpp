@@ -3,6 +3,7 @@
 
 #ifndef ITU_UNITY_BUILD
 #include <itu_lib_engine.hpp>
+#include <itu_lib_render_queue.hpp>
 #endif
 
 struct Sprite
@@ -12,6 +13,7 @@ struct Sprite
 	vec2f        pivot;
 	color        tint;
 	bool         flip_horizontal;
+	Uint8        layer; // render queue layer (lower layers are drawn first)
 };
 
 void itu_lib_sprite_init(Sprite* sprite, SDL_Texture* texture, SDL_FRect rect);
@@ -20,6 +22,19 @@ SDL_FRect itu_lib_sprite_get_screen_rect(SDLContext* context, Sprite* sprite, Tr
 vec2f itu_lib_sprite_get_world_size(SDLContext* context, Sprite* sprite, Transform* transform);
 void itu_lib_sprite_render(SDLContext* context, Sprite* sprite, Transform* transform);
 void itu_lib_sprite_render_debug(SDLContext* context, Sprite* sprite, Transform* transform);
+void itu_lib_sprite_get_quad(Sprite* sprite, SDL_FRect rect_dst, float rotation, SDL_Vertex* out_vertices);
+void itu_lib_sprite_queue(SDLContext* context, Sprite* sprite, Transform* transform);
+
+// sprite batching
+// sprites added between `begin` and `end` are turned into rotated and tinted quads (tint is carried by vertex colors),
+// accumulated per texture, and submitted with a single `SDL_RenderGeometry` per texture when calling `end`
+// NOTE: textures are flushed in the order they were first used in the batch, so sprites using different textures
+//       are not guaranteed to be drawn in the order they were added
+// NOTE: this is meant for games drawing their sprites directly. `itu_system_sprite_render()` goes through the render queue
+//       instead, which batches the same way but also keeps layering
+void itu_lib_sprite_batch_begin(SDLContext* context);
+void itu_lib_sprite_batch_add(SDLContext* context, Sprite* sprite, Transform* transform);
+void itu_lib_sprite_batch_end(SDLContext* context);
 
 #endif // ITU_LIB_SPRITE_HPP
 
@@ -35,6 +50,7 @@ void itu_lib_sprite_init(Sprite* sprite, SDL_Texture* texture, SDL_FRect rect)
 	sprite->rect = rect;
 	sprite->pivot = vec2f{ 0.5f, 0.5f };
 	sprite->tint = COLOR_WHITE;
+	sprite->layer = 0;
 }
 
 SDL_FRect itu_lib_sprite_get_rect(int x, int y, int tile_w, int tile_h)
@@ -100,4 +116,133 @@ void itu_lib_sprite_render_debug(SDLContext* context, Sprite* sprite, Transform*
 	itu_lib_render_draw_point(context->renderer, pos, 5, COLOR_YELLOW);
 }
 
+// builds the 4 vertices of the sprite quad (clockwise, starting top left), rotated around the sprite pivot
+// `rect_dst` is in screen space
+// NOTE: same math used by `SDL_RenderTextureRotated`, so that batched and non-batched sprites look exactly the same
+void itu_lib_sprite_get_quad(Sprite* sprite, SDL_FRect rect_dst, float rotation, SDL_Vertex* out_vertices)
+{
+	vec2f pivot_dst;
+	pivot_dst.x = rect_dst.x + sprite->pivot.x * rect_dst.w;
+	pivot_dst.y = rect_dst.y + sprite->pivot.y * rect_dst.h;
+
+	// SDL rotates clockwise, our rotation is counter-clockwise (hence the flipped sine)
+	float s = -SDL_sinf(rotation);
+	float c =  SDL_cosf(rotation);
+
+	float min_x = rect_dst.x - pivot_dst.x;
+	float min_y = rect_dst.y - pivot_dst.y;
+	float max_x = min_x + rect_dst.w;
+	float max_y = min_y + rect_dst.h;
+
+	float tex_w = (float)sprite->texture->w;
+	float tex_h = (float)sprite->texture->h;
+	float u0 = sprite->rect.x / tex_w;
+	float v0 = sprite->rect.y / tex_h;
+	float u1 = (sprite->rect.x + sprite->rect.w) / tex_w;
+	float v1 = (sprite->rect.y + sprite->rect.h) / tex_h;
+	if(sprite->flip_horizontal)
+	{
+		float tmp = u0;
+		u0 = u1;
+		u1 = tmp;
+	}
+
+	SDL_FColor tint = { sprite->tint.r, sprite->tint.g, sprite->tint.b, sprite->tint.a };
+
+	SDL_Vertex* vs = out_vertices;
+	vs[0].position = SDL_FPoint{ c * min_x - s * min_y + pivot_dst.x, s * min_x + c * min_y + pivot_dst.y }; // top left
+	vs[1].position = SDL_FPoint{ c * max_x - s * min_y + pivot_dst.x, s * max_x + c * min_y + pivot_dst.y }; // top right
+	vs[2].position = SDL_FPoint{ c * max_x - s * max_y + pivot_dst.x, s * max_x + c * max_y + pivot_dst.y }; // bottom right
+	vs[3].position = SDL_FPoint{ c * min_x - s * max_y + pivot_dst.x, s * min_x + c * max_y + pivot_dst.y }; // bottom left
+	vs[0].tex_coord = SDL_FPoint{ u0, v0 };
+	vs[1].tex_coord = SDL_FPoint{ u1, v0 };
+	vs[2].tex_coord = SDL_FPoint{ u1, v1 };
+	vs[3].tex_coord = SDL_FPoint{ u0, v1 };
+	vs[0].color = vs[1].color = vs[2].color = vs[3].color = tint;
+}
+
+// pushes the sprite in the render queue, using its layer and the screen-space y of its pivot as depth
+void itu_lib_sprite_queue(SDLContext* context, Sprite* sprite, Transform* transform)
+{
+	SDL_FRect rect_dst = itu_lib_sprite_get_screen_rect(context, sprite, transform);
+
+	SDL_Vertex vs[4];
+	itu_lib_sprite_get_quad(sprite, rect_dst, transform->rotation, vs);
+	itu_lib_render_queue_push_quad(sprite->layer, rect_dst.y + sprite->pivot.y * rect_dst.h, sprite->texture, vs);
+}
+
+struct ITU_SpriteBatch
+{
+	SDL_Texture* texture;
+	stbds_arr(SDL_Vertex) vertices;
+	stbds_arr(int)        indices;
+};
+
+// NOTE: batches are kept alive across frames, so that their buffers only grow during the first few frames
+static stbds_arr(ITU_SpriteBatch)    sprite_batches;
+static stbds_hm(SDL_Texture*, int)   sprite_batches_lookup; // texture -> index in `sprite_batches`
+static stbds_arr(int)                sprite_batches_used;   // batches touched this frame, in order of first use
+
+void itu_lib_sprite_batch_begin(SDLContext* context)
+{
+	for(int i = 0; i < stbds_arrlen(sprite_batches_used); ++i)
+	{
+		ITU_SpriteBatch* batch = &sprite_batches[sprite_batches_used[i]];
+		stbds_arrsetlen(batch->vertices, 0);
+		stbds_arrsetlen(batch->indices, 0);
+	}
+	stbds_arrsetlen(sprite_batches_used, 0);
+}
+
+void itu_lib_sprite_batch_add(SDLContext* context, Sprite* sprite, Transform* transform)
+{
+	int batch_idx;
+	int loc_lookup = stbds_hmgeti(sprite_batches_lookup, sprite->texture);
+	if(loc_lookup != -1)
+		batch_idx = sprite_batches_lookup[loc_lookup].value;
+	else
+	{
+		ITU_SpriteBatch batch_new = { 0 };
+		batch_new.texture = sprite->texture;
+		batch_idx = stbds_arrlen(sprite_batches);
+		stbds_arrput(sprite_batches, batch_new);
+		stbds_hmput(sprite_batches_lookup, sprite->texture, batch_idx);
+	}
+
+	ITU_SpriteBatch* batch = &sprite_batches[batch_idx];
+	if(stbds_arrlen(batch->vertices) == 0)
+		stbds_arrput(sprite_batches_used, batch_idx);
+
+	SDL_FRect rect_dst = itu_lib_sprite_get_screen_rect(context, sprite, transform);
+
+	int index_first = stbds_arrlen(batch->vertices);
+	SDL_Vertex* vs = stbds_arraddnptr(batch->vertices, 4);
+	itu_lib_sprite_get_quad(sprite, rect_dst, transform->rotation, vs);
+
+	int* indices = stbds_arraddnptr(batch->indices, 6);
+	indices[0] = index_first + 0;
+	indices[1] = index_first + 1;
+	indices[2] = index_first + 2;
+	indices[3] = index_first + 0;
+	indices[4] = index_first + 2;
+	indices[5] = index_first + 3;
+}
+
+void itu_lib_sprite_batch_end(SDLContext* context)
+{
+	for(int i = 0; i < stbds_arrlen(sprite_batches_used); ++i)
+	{
+		ITU_SpriteBatch* batch = &sprite_batches[sprite_batches_used[i]];
+
+		// texture color mod is multiplied with vertex colors, so we need to clear any tint left by non-batched rendering
+		sdl_set_texture_tint(batch->texture, COLOR_WHITE);
+		SDL_RenderGeometry(
+			context->renderer,
+			batch->texture,
+			batch->vertices, stbds_arrlen(batch->vertices),
+			batch->indices,  stbds_arrlen(batch->indices)
+		);
+	}
+}
+
 #endif // ITU_LIB_SPRITE_IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,360 @@
+// itu_lib_spritetable.hpp
+// importer for sprite descriptions, so that sprites can be referenced by name instead of hardcoded rects
+// supported sources:
+// - Kenney TextureAtlas XMLs (`<SubTexture name="..." x="..." y="..." width="..." height="..."/>`)
+// - Kenney `_tilesheets.txt` grid specs. Tiles are named `<sheet name>_<tile index>`, with tiles indexed row by row
+//   (ie, the tile at column `x` and row `y` is `y * cols + x`)
+//
+// the parsed result is a single flat blob (header, entries sorted by name hash, string table), which is also
+// written next to the source file as a binary sidecar (`<source>.cache`). Following loads just read the
+// sidecar back, as long as the source file has not been modified since
+//
+// limitations
+// - the XML "parser" only understands the Kenney format (one attribute list per SubTexture, no nesting, no escaping)
+// - the cache is only checked against the source modification time, and it is not portable across architectures
+
+#ifndef ITU_LIB_SPRITETABLE_HPP
+#define ITU_LIB_SPRITETABLE_HPP
+
+#ifndef ITU_UNITY_BUILD
+#include <SDL3/SDL.h>
+#include <stb_ds.h>
+#include <itu_common.hpp>
+#include <itu_lib_fileutils.hpp>
+#endif
+
+#define SPRITETABLE_MAGIC   0x54535449 // "ITST"
+#define SPRITETABLE_VERSION 1
+
+struct ITU_SpriteTableEntry
+{
+	Uint32   name_hash;
+	Uint32   name_offset;  // offset in the string table
+	Uint32   image_offset; // offset in the string table (path of the image, relative to the working directory)
+	SDL_Rect rect;
+};
+
+// NOTE: this header is immediately followed in memory by `entries_count` entries and `strings_size` bytes of strings
+struct ITU_SpriteTable
+{
+	Uint32 magic;
+	Uint32 version;
+	Sint64 source_modify_time;
+	Uint32 entries_count;
+	Uint32 strings_size;
+};
+
+ITU_SpriteTable* itu_lib_spritetable_load_xml(const char* path);
+ITU_SpriteTable* itu_lib_spritetable_load_tilesheets(const char* path);
+void             itu_lib_spritetable_free(ITU_SpriteTable* table);
+
+int  itu_lib_spritetable_find(ITU_SpriteTable* table, const char* name);
+bool itu_lib_spritetable_get(ITU_SpriteTable* table, const char* name, const char** out_image_path, SDL_Rect* out_rect);
+
+ITU_SpriteTableEntry* itu_lib_spritetable_entries(ITU_SpriteTable* table);
+const char*           itu_lib_spritetable_string(ITU_SpriteTable* table, Uint32 offset);
+
+#endif // ITU_LIB_SPRITETABLE_HPP
+
+#if (defined ITU_LIB_SPRITETABLE_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
+
+// temporary data used while parsing a source file
+struct ITU_SpriteTableBuilder
+{
+	stbds_arr(ITU_SpriteTableEntry) entries;
+	stbds_arr(char)                 strings;
+};
+
+static Uint32 itu_lib_spritetable_hash(const char* name)
+{
+	return SDL_murmur3_32(name, SDL_strlen(name), 0);
+}
+
+ITU_SpriteTableEntry* itu_lib_spritetable_entries(ITU_SpriteTable* table)
+{
+	return pointer_offset(ITU_SpriteTableEntry, table, sizeof(ITU_SpriteTable));
+}
+
+const char* itu_lib_spritetable_string(ITU_SpriteTable* table, Uint32 offset)
+{
+	char* strings = pointer_offset(char, itu_lib_spritetable_entries(table), sizeof(ITU_SpriteTableEntry) * table->entries_count);
+	return strings + offset;
+}
+
+static Uint32 itu_lib_spritetable_builder_add_string(ITU_SpriteTableBuilder* builder, const char* str, int len)
+{
+	Uint32 offset = stbds_arrlen(builder->strings);
+	char* dst = stbds_arraddnptr(builder->strings, len + 1);
+	SDL_memcpy(dst, str, len);
+	dst[len] = 0;
+	return offset;
+}
+
+static void itu_lib_spritetable_builder_add(ITU_SpriteTableBuilder* builder, const char* name, int name_len, Uint32 image_offset, SDL_Rect rect)
+{
+	ITU_SpriteTableEntry entry;
+	entry.name_offset = itu_lib_spritetable_builder_add_string(builder, name, name_len);
+	entry.name_hash = itu_lib_spritetable_hash(&builder->strings[entry.name_offset]);
+	entry.image_offset = image_offset;
+	entry.rect = rect;
+	stbds_arrput(builder->entries, entry);
+}
+
+static int itu_lib_spritetable_compare_entries(const void* a, const void* b)
+{
+	Uint32 hash_a = ((ITU_SpriteTableEntry*)a)->name_hash;
+	Uint32 hash_b = ((ITU_SpriteTableEntry*)b)->name_hash;
+	return hash_a < hash_b ? -1 : hash_a > hash_b ? 1 : 0;
+}
+
+// sorts the entries and packs everything in a single blob (the same layout we store in the sidecar)
+static ITU_SpriteTable* itu_lib_spritetable_builder_finalize(ITU_SpriteTableBuilder* builder, Sint64 source_modify_time)
+{
+	int entries_count = stbds_arrlen(builder->entries);
+	int strings_size  = stbds_arrlen(builder->strings);
+	SDL_qsort(builder->entries, entries_count, sizeof(ITU_SpriteTableEntry), itu_lib_spritetable_compare_entries);
+
+	ITU_SpriteTable* table = (ITU_SpriteTable*)SDL_malloc(sizeof(ITU_SpriteTable) + sizeof(ITU_SpriteTableEntry) * entries_count + strings_size);
+	table->magic = SPRITETABLE_MAGIC;
+	table->version = SPRITETABLE_VERSION;
+	table->source_modify_time = source_modify_time;
+	table->entries_count = entries_count;
+	table->strings_size = strings_size;
+	SDL_memcpy(itu_lib_spritetable_entries(table), builder->entries, sizeof(ITU_SpriteTableEntry) * entries_count);
+	SDL_memcpy((void*)itu_lib_spritetable_string(table, 0), builder->strings, strings_size);
+
+	stbds_arrfree(builder->entries);
+	stbds_arrfree(builder->strings);
+
+	return table;
+}
+
+static Uint64 itu_lib_spritetable_size(ITU_SpriteTable* table)
+{
+	return sizeof(ITU_SpriteTable) + sizeof(ITU_SpriteTableEntry) * table->entries_count + table->strings_size;
+}
+
+// returns the cached table if it exists and it's up to date with the source, NULL otherwise
+static ITU_SpriteTable* itu_lib_spritetable_cache_load(const char* path_cache, Sint64 source_modify_time)
+{
+	size_t size;
+	ITU_SpriteTable* table = (ITU_SpriteTable*)SDL_LoadFile(path_cache, &size);
+	if(!table)
+		return NULL;
+
+	if(size < sizeof(ITU_SpriteTable) ||
+	   table->magic != SPRITETABLE_MAGIC ||
+	   table->version != SPRITETABLE_VERSION ||
+	   table->source_modify_time != source_modify_time ||
+	   size != itu_lib_spritetable_size(table))
+	{
+		SDL_free(table);
+		return NULL;
+	}
+
+	return table;
+}
+
+// common path for all sources: try the sidecar first, and only parse the source (and write the sidecar) if needed
+static ITU_SpriteTable* itu_lib_spritetable_load(const char* path, void (*fn_parse)(ITU_SpriteTableBuilder* builder, const char* path, char* text))
+{
+	SDL_PathInfo info;
+	if(!SDL_GetPathInfo(path, &info))
+	{
+		SDL_Log("WARNING can't find sprite table source '%s'\n", path);
+		return NULL;
+	}
+
+	char path_cache[512];
+	SDL_snprintf(path_cache, 512, "%s.cache", path);
+
+	ITU_SpriteTable* table = itu_lib_spritetable_cache_load(path_cache, info.modify_time);
+	if(table)
+		return table;
+
+	char* text = (char*)SDL_LoadFile(path, NULL);
+	if(!text)
+	{
+		SDL_Log("%s\n", SDL_GetError());
+		return NULL;
+	}
+
+	ITU_SpriteTableBuilder builder = { 0 };
+	fn_parse(&builder, path, text);
+	SDL_free(text);
+
+	table = itu_lib_spritetable_builder_finalize(&builder, info.modify_time);
+	if(!SDL_SaveFile(path_cache, table, itu_lib_spritetable_size(table)))
+		SDL_Log("WARNING can't write sprite table cache '%s'\n", path_cache);
+
+	return table;
+}
+
+// length of the directory part of the path (including the trailing separator)
+static int itu_lib_spritetable_dir_len(const char* path)
+{
+	return (int)(itu_lib_fileutils_get_file_name(path) - path);
+}
+
+// finds `attribute="` inside [tag, tag_end) and returns a pointer to the value (and its length in `out_len`)
+static const char* itu_lib_spritetable_xml_attribute(const char* tag, const char* tag_end, const char* attribute, int* out_len)
+{
+	int attribute_len = SDL_strlen(attribute);
+	for(const char* c = tag; c + attribute_len + 2 < tag_end; ++c)
+	{
+		if(SDL_strncmp(c, attribute, attribute_len) != 0 || c[attribute_len] != '=' || c[attribute_len + 1] != '"')
+			continue;
+		// make sure we didn't match the end of a longer attribute name
+		if(c > tag && !SDL_isspace(c[-1]))
+			continue;
+
+		const char* value = c + attribute_len + 2;
+		const char* value_end = SDL_strchr(value, '"');
+		if(!value_end || value_end > tag_end)
+			return NULL;
+		*out_len = (int)(value_end - value);
+		return value;
+	}
+	return NULL;
+}
+
+static void itu_lib_spritetable_parse_xml(ITU_SpriteTableBuilder* builder, const char* path, char* text)
+{
+	const char* atlas = SDL_strstr(text, "<TextureAtlas");
+	if(!atlas)
+	{
+		SDL_Log("WARNING '%s' is not a TextureAtlas\n", path);
+		return;
+	}
+
+	// image path is relative to the xml
+	const char* atlas_end = SDL_strchr(atlas, '>');
+	int image_len;
+	const char* image = itu_lib_spritetable_xml_attribute(atlas, atlas_end, "imagePath", &image_len);
+	if(!image)
+	{
+		SDL_Log("WARNING '%s' has no imagePath\n", path);
+		return;
+	}
+
+	char image_path[512];
+	int dir_len = itu_lib_spritetable_dir_len(path);
+	SDL_snprintf(image_path, 512, "%.*s%.*s", dir_len, path, image_len, image);
+	Uint32 image_offset = itu_lib_spritetable_builder_add_string(builder, image_path, SDL_strlen(image_path));
+
+	for(const char* tag = SDL_strstr(atlas_end, "<SubTexture"); tag; tag = SDL_strstr(tag + 1, "<SubTexture"))
+	{
+		const char* tag_end = SDL_strchr(tag, '>');
+		if(!tag_end)
+			break;
+
+		int len_name, len_x, len_y, len_w, len_h;
+		const char* name = itu_lib_spritetable_xml_attribute(tag, tag_end, "name",   &len_name);
+		const char* x    = itu_lib_spritetable_xml_attribute(tag, tag_end, "x",      &len_x);
+		const char* y    = itu_lib_spritetable_xml_attribute(tag, tag_end, "y",      &len_y);
+		const char* w    = itu_lib_spritetable_xml_attribute(tag, tag_end, "width",  &len_w);
+		const char* h    = itu_lib_spritetable_xml_attribute(tag, tag_end, "height", &len_h);
+		if(!name || !x || !y || !w || !h)
+		{
+			SDL_Log("WARNING skipping malformed SubTexture in '%s'\n", path);
+			continue;
+		}
+
+		// NOTE: SDL_atoi stops at the closing quote
+		SDL_Rect rect = { SDL_atoi(x), SDL_atoi(y), SDL_atoi(w), SDL_atoi(h) };
+		itu_lib_spritetable_builder_add(builder, name, len_name, image_offset, rect);
+	}
+}
+
+static void itu_lib_spritetable_parse_tilesheets(ITU_SpriteTableBuilder* builder, const char* path, char* text)
+{
+	int dir_len = itu_lib_spritetable_dir_len(path);
+
+	// first line is the header
+	char* line = SDL_strchr(text, '\n');
+	while(line)
+	{
+		line++;
+		char* line_end = SDL_strchr(line, '\n');
+		if(line_end)
+			*line_end = 0;
+
+		char name[128];
+		int tile_w, tile_h, rows, cols, total;
+		if(SDL_sscanf(line, "%127s %dpx x %dpx %d %d %d", name, &tile_w, &tile_h, &rows, &cols, &total) == 6)
+		{
+			char image_path[512];
+			SDL_snprintf(image_path, 512, "%.*s%s.png", dir_len, path, name);
+			Uint32 image_offset = itu_lib_spritetable_builder_add_string(builder, image_path, SDL_strlen(image_path));
+
+			for(int i = 0; i < rows * cols; ++i)
+			{
+				char tile_name[160];
+				int tile_name_len = SDL_snprintf(tile_name, 160, "%s_%d", name, i);
+				SDL_Rect rect = { (i % cols) * tile_w, (i / cols) * tile_h, tile_w, tile_h };
+				itu_lib_spritetable_builder_add(builder, tile_name, tile_name_len, image_offset, rect);
+			}
+		}
+
+		line = line_end;
+	}
+}
+
+ITU_SpriteTable* itu_lib_spritetable_load_xml(const char* path)
+{
+	return itu_lib_spritetable_load(path, itu_lib_spritetable_parse_xml);
+}
+
+ITU_SpriteTable* itu_lib_spritetable_load_tilesheets(const char* path)
+{
+	return itu_lib_spritetable_load(path, itu_lib_spritetable_parse_tilesheets);
+}
+
+void itu_lib_spritetable_free(ITU_SpriteTable* table)
+{
+	SDL_free(table);
+}
+
+// returns the index of the entry with the given name, or -1 if there is none
+// binary search on the hash, then string compare on the (very likely single) entries sharing it
+int itu_lib_spritetable_find(ITU_SpriteTable* table, const char* name)
+{
+	ITU_SpriteTableEntry* entries = itu_lib_spritetable_entries(table);
+	Uint32 hash = itu_lib_spritetable_hash(name);
+
+	int lo = 0;
+	int hi = table->entries_count;
+	while(lo < hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		if(entries[mid].name_hash < hash)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for(int i = lo; i < (int)table->entries_count && entries[i].name_hash == hash; ++i)
+		if(SDL_strcmp(itu_lib_spritetable_string(table, entries[i].name_offset), name) == 0)
+			return i;
+
+	return -1;
+}
+
+bool itu_lib_spritetable_get(ITU_SpriteTable* table, const char* name, const char** out_image_path, SDL_Rect* out_rect)
+{
+	int loc = itu_lib_spritetable_find(table, name);
+	if(loc == -1)
+	{
+		SDL_Log("WARNING sprite '%s' not found\n", name);
+		return false;
+	}
+
+	ITU_SpriteTableEntry* entry = &itu_lib_spritetable_entries(table)[loc];
+	if(out_image_path)
+		*out_image_path = itu_lib_spritetable_string(table, entry->image_offset);
+	if(out_rect)
+		*out_rect = entry->rect;
+	return true;
+}
+
+#endif // (defined ITU_LIB_SPRITETABLE_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
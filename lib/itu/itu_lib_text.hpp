@@ -0,0 +1,406 @@
+// itu_lib_text.hpp
+// text rendering through shared glyph atlases, as an alternative to one `TTF_Text` per widget
+// - glyphs are rasterized on demand (in white, so that they can be tinted with vertex colors) the first time they
+//   are used with a given (font, size), and packed in an atlas texture owned by that (font, size) pair
+// - laid out runs (glyph quads relative to the run origin) are cached by string hash, so drawing the same label
+//   every frame is just a lookup
+// - drawing pushes one quad per glyph in the render queue, so all text using the same atlas ends up in a single draw call
+//
+// limitations
+// - a single atlas page per (font, size). When it's full, new glyphs are skipped (with a warning)
+// - no complex shaping (ligatures, RTL, ...), just kerning between codepoint pairs
+// - the run cache is simply cleared when it gets too big
+// - changing size on a font shared with `TTF_Text` objects is fine (original size is restored), but slow:
+//   it only happens when something new needs to be rasterized or laid out
+
+#ifndef ITU_LIB_TEXT_HPP
+#define ITU_LIB_TEXT_HPP
+
+#ifndef ITU_UNITY_BUILD
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <stb_ds.h>
+#include <itu_common.hpp>
+#include <itu_lib_engine.hpp>
+#include <itu_lib_render_queue.hpp>
+#endif
+
+// size (in pixels) of each glyph atlas
+#ifndef TEXT_ATLAS_SIZE
+#define TEXT_ATLAS_SIZE 1024
+#endif
+
+// max number of laid out runs kept around
+#ifndef TEXT_RUN_CACHE_MAX
+#define TEXT_RUN_CACHE_MAX 1024
+#endif
+
+struct ITU_TextStats
+{
+	int faces_count;        // (font, size) pairs seen so far
+	int glyphs_count;       // glyphs rasterized so far, in all atlases
+	int runs_count;         // runs currently cached
+	int runs_built;         // runs laid out since last call to `itu_lib_text_get_stats()` (ie, cache misses)
+};
+
+// `position` is in screen space, `pivot` is normalized inside the text rect (ie, { 0.5, 0.5 } to center the text)
+void  itu_lib_text_queue(SDLContext* context, TTF_Font* font, float size, const char* text, vec2f position, vec2f pivot, color tint, Uint8 layer);
+vec2f itu_lib_text_measure(SDLContext* context, TTF_Font* font, float size, const char* text);
+void  itu_lib_text_clear_cache();
+void  itu_lib_text_free();
+
+SDL_Texture*  itu_lib_text_get_atlas(SDLContext* context, TTF_Font* font, float size);
+ITU_TextStats itu_lib_text_get_stats();
+
+#endif // ITU_LIB_TEXT_HPP
+
+#if (defined ITU_LIB_TEXT_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
+
+// padding between glyphs in the atlas, so that linear filtering doesn't bleed into neighbours
+#define TEXT_ATLAS_PADDING 1
+
+struct ITU_TextGlyph
+{
+	SDL_FRect rect_src;  // in atlas pixels (0 size for glyphs with nothing to draw)
+	float     advance;
+};
+
+struct ITU_TextFace
+{
+	TTF_Font*    font;
+	float        size;
+	SDL_Texture* atlas;
+	float        line_skip;
+
+	// shelf packing state
+	int shelf_x;
+	int shelf_y;
+	int shelf_h;
+	bool full;
+
+	stbds_hm(Uint32, ITU_TextGlyph) glyphs;
+};
+
+struct ITU_TextRunGlyph
+{
+	SDL_FRect rect;  // relative to the run top-left corner
+	SDL_FRect uv;
+};
+
+struct ITU_TextRun
+{
+	ITU_TextFace* face;
+	int   text_offset;     // in `ctx_text.run_strings`
+	int   text_length;
+	int   glyph_first;     // in `ctx_text.run_glyphs`
+	int   glyph_count;
+	vec2f size;
+};
+
+struct ITU_TextContext
+{
+	stbds_arr(ITU_TextFace*) faces;
+
+	stbds_hm(Uint64, int)        runs_lookup; // hash -> index in `runs`
+	stbds_arr(ITU_TextRun)       runs;
+	stbds_arr(ITU_TextRunGlyph)  run_glyphs;
+	stbds_arr(char)              run_strings;
+
+	ITU_TextStats stats;
+};
+
+static ITU_TextContext ctx_text;
+
+// NOTE: SDL_ttf only keeps one size per font, so we switch it (and back) only when we actually need to talk to it
+static float itu_lib_text_face_begin(ITU_TextFace* face)
+{
+	float size_prev = TTF_GetFontSize(face->font);
+	if(size_prev != face->size)
+		TTF_SetFontSize(face->font, face->size);
+	return size_prev;
+}
+
+static void itu_lib_text_face_end(ITU_TextFace* face, float size_prev)
+{
+	if(size_prev != face->size)
+		TTF_SetFontSize(face->font, size_prev);
+}
+
+static ITU_TextFace* itu_lib_text_face_get(SDLContext* context, TTF_Font* font, float size)
+{
+	for(int i = 0; i < stbds_arrlen(ctx_text.faces); ++i)
+		if(ctx_text.faces[i]->font == font && ctx_text.faces[i]->size == size)
+			return ctx_text.faces[i];
+
+	SDL_Texture* atlas = SDL_CreateTexture(context->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, TEXT_ATLAS_SIZE, TEXT_ATLAS_SIZE);
+	if(!atlas)
+	{
+		SDL_Log("WARNING can't create glyph atlas: %s\n", SDL_GetError());
+		return NULL;
+	}
+	SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+	SDL_SetTextureScaleMode(atlas, SDL_SCALEMODE_LINEAR);
+
+	// static textures start with undefined content, and we want padding to be transparent
+	void* pixels_clear = SDL_calloc(TEXT_ATLAS_SIZE * TEXT_ATLAS_SIZE, 4);
+	if(pixels_clear)
+	{
+		SDL_UpdateTexture(atlas, NULL, pixels_clear, TEXT_ATLAS_SIZE * 4);
+		SDL_free(pixels_clear);
+	}
+
+	ITU_TextFace* face = (ITU_TextFace*)SDL_calloc(1, sizeof(ITU_TextFace));
+	face->font = font;
+	face->size = size;
+	face->atlas = atlas;
+	face->shelf_x = TEXT_ATLAS_PADDING;
+	face->shelf_y = TEXT_ATLAS_PADDING;
+
+	float size_prev = itu_lib_text_face_begin(face);
+	face->line_skip = (float)TTF_GetFontLineSkip(font);
+	itu_lib_text_face_end(face, size_prev);
+
+	stbds_arrput(ctx_text.faces, face);
+	ctx_text.stats.faces_count = stbds_arrlen(ctx_text.faces);
+	return face;
+}
+
+// NOTE: font must already be at the face size (see `itu_lib_text_face_begin()`)
+static ITU_TextGlyph itu_lib_text_glyph_get(ITU_TextFace* face, Uint32 codepoint)
+{
+	int loc = stbds_hmgeti(face->glyphs, codepoint);
+	if(loc != -1)
+		return face->glyphs[loc].value;
+
+	ITU_TextGlyph glyph = { 0 };
+
+	int advance = 0;
+	if(TTF_GetGlyphMetrics(face->font, codepoint, NULL, NULL, NULL, NULL, &advance))
+		glyph.advance = (float)advance;
+
+	// NOTE: surface is as tall as the line (glyph is already placed relative to the baseline),
+	//       so glyph quads can just be placed at the top of the line
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	SDL_Surface* surface = codepoint > ' ' ? TTF_RenderGlyph_Blended(face->font, codepoint, white) : NULL;
+	if(surface && surface->format != SDL_PIXELFORMAT_ARGB8888)
+	{
+		SDL_Surface* converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+		SDL_DestroySurface(surface);
+		surface = converted;
+	}
+
+	if(surface && !face->full)
+	{
+		// next shelf
+		if(face->shelf_x + surface->w + TEXT_ATLAS_PADDING > TEXT_ATLAS_SIZE)
+		{
+			face->shelf_x = TEXT_ATLAS_PADDING;
+			face->shelf_y += face->shelf_h + TEXT_ATLAS_PADDING;
+			face->shelf_h = 0;
+		}
+
+		if(face->shelf_y + surface->h + TEXT_ATLAS_PADDING > TEXT_ATLAS_SIZE || surface->w + 2 * TEXT_ATLAS_PADDING > TEXT_ATLAS_SIZE)
+		{
+			SDL_Log("WARNING glyph atlas full (font size %.1f), new glyphs will be skipped\n", face->size);
+			face->full = true;
+		}
+		else
+		{
+			SDL_Rect rect = { face->shelf_x, face->shelf_y, surface->w, surface->h };
+			SDL_UpdateTexture(face->atlas, &rect, surface->pixels, surface->pitch);
+
+			glyph.rect_src = SDL_FRect{ (float)rect.x, (float)rect.y, (float)rect.w, (float)rect.h };
+
+			face->shelf_x += surface->w + TEXT_ATLAS_PADDING;
+			face->shelf_h = SDL_max(face->shelf_h, surface->h);
+		}
+	}
+	SDL_DestroySurface(surface);
+
+	stbds_hmput(face->glyphs, codepoint, glyph);
+	ctx_text.stats.glyphs_count++;
+	return glyph;
+}
+
+static void itu_lib_text_run_layout(ITU_TextRun* run, const char* text, size_t text_length)
+{
+	ITU_TextFace* face = run->face;
+	float size_prev = itu_lib_text_face_begin(face);
+
+	run->glyph_first = stbds_arrlen(ctx_text.run_glyphs);
+	run->glyph_count = 0;
+	run->size = VEC2F_ZERO;
+
+	float pen_x = 0;
+	float pen_y = 0;
+	Uint32 codepoint_prev = 0;
+	while(text_length > 0)
+	{
+		Uint32 codepoint = SDL_StepUTF8(&text, &text_length);
+		if(codepoint == '\n')
+		{
+			run->size.x = SDL_max(run->size.x, pen_x);
+			pen_x = 0;
+			pen_y += face->line_skip;
+			codepoint_prev = 0;
+			continue;
+		}
+
+		int kerning = 0;
+		if(codepoint_prev && TTF_GetGlyphKerning(face->font, codepoint_prev, codepoint, &kerning))
+			pen_x += kerning;
+
+		ITU_TextGlyph glyph = itu_lib_text_glyph_get(face, codepoint);
+		if(glyph.rect_src.w > 0)
+		{
+			ITU_TextRunGlyph run_glyph;
+			run_glyph.rect = SDL_FRect{ pen_x, pen_y, glyph.rect_src.w, glyph.rect_src.h };
+			run_glyph.uv.x = glyph.rect_src.x / TEXT_ATLAS_SIZE;
+			run_glyph.uv.y = glyph.rect_src.y / TEXT_ATLAS_SIZE;
+			run_glyph.uv.w = glyph.rect_src.w / TEXT_ATLAS_SIZE;
+			run_glyph.uv.h = glyph.rect_src.h / TEXT_ATLAS_SIZE;
+			stbds_arrput(ctx_text.run_glyphs, run_glyph);
+			run->glyph_count++;
+		}
+
+		pen_x += glyph.advance;
+		codepoint_prev = codepoint;
+	}
+	run->size.x = SDL_max(run->size.x, pen_x);
+	run->size.y = pen_y + face->line_skip;
+
+	itu_lib_text_face_end(face, size_prev);
+}
+
+static ITU_TextRun* itu_lib_text_run_get(SDLContext* context, TTF_Font* font, float size, const char* text)
+{
+	ITU_TextFace* face = itu_lib_text_face_get(context, font, size);
+	if(!face)
+		return NULL;
+
+	size_t text_length = SDL_strlen(text);
+
+	// face pointer is mixed in the hash, so the same string with different fonts (or sizes) gets different runs
+	Uint64 face_bits = (Uint64)(uintptr_t)face;
+	Uint64 hash = ((Uint64)SDL_murmur3_32(text, text_length, (Uint32)face_bits) << 32) | (Uint32)text_length;
+	hash ^= face_bits;
+
+	int loc = stbds_hmgeti(ctx_text.runs_lookup, hash);
+	if(loc != -1)
+	{
+		ITU_TextRun* run = &ctx_text.runs[ctx_text.runs_lookup[loc].value];
+		// hashes could collide, so we check the actual string too
+		if(run->face == face && run->text_length == (int)text_length && SDL_memcmp(&ctx_text.run_strings[run->text_offset], text, text_length) == 0)
+			return run;
+	}
+
+	if(stbds_arrlen(ctx_text.runs) >= TEXT_RUN_CACHE_MAX)
+		itu_lib_text_clear_cache();
+
+	ITU_TextRun run;
+	run.face = face;
+	run.text_offset = stbds_arrlen(ctx_text.run_strings);
+	run.text_length = (int)text_length;
+	SDL_memcpy(stbds_arraddnptr(ctx_text.run_strings, text_length), text, text_length);
+	itu_lib_text_run_layout(&run, text, text_length);
+
+	// NOTE: on collisions the old run is simply forgotten (its data stays around until the cache is cleared)
+	stbds_hmput(ctx_text.runs_lookup, hash, stbds_arrlen(ctx_text.runs));
+	stbds_arrput(ctx_text.runs, run);
+	ctx_text.stats.runs_count = stbds_arrlen(ctx_text.runs);
+	ctx_text.stats.runs_built++;
+
+	return &stbds_arrlast(ctx_text.runs);
+}
+
+void itu_lib_text_queue(SDLContext* context, TTF_Font* font, float size, const char* text, vec2f position, vec2f pivot, color tint, Uint8 layer)
+{
+	ITU_TextRun* run = itu_lib_text_run_get(context, font, size, text);
+	if(!run)
+		return;
+
+	// snap to pixels, glyphs are rasterized at their final size and we don't want to blur them
+	vec2f origin;
+	origin.x = SDL_roundf(position.x - pivot.x * run->size.x);
+	origin.y = SDL_roundf(position.y - pivot.y * run->size.y);
+
+	SDL_FColor tint_vertex = { tint.r, tint.g, tint.b, tint.a };
+	SDL_Texture* atlas = run->face->atlas;
+	ITU_TextRunGlyph* glyphs = &ctx_text.run_glyphs[run->glyph_first];
+	for(int i = 0; i < run->glyph_count; ++i)
+	{
+		ITU_TextRunGlyph* glyph = &glyphs[i];
+
+		float x0 = origin.x + glyph->rect.x;
+		float y0 = origin.y + glyph->rect.y;
+		float x1 = x0 + glyph->rect.w;
+		float y1 = y0 + glyph->rect.h;
+		float u0 = glyph->uv.x;
+		float v0 = glyph->uv.y;
+		float u1 = u0 + glyph->uv.w;
+		float v1 = v0 + glyph->uv.h;
+
+		SDL_Vertex vs[4];
+		vs[0].position = SDL_FPoint{ x0, y0 }; vs[0].tex_coord = SDL_FPoint{ u0, v0 };
+		vs[1].position = SDL_FPoint{ x1, y0 }; vs[1].tex_coord = SDL_FPoint{ u1, v0 };
+		vs[2].position = SDL_FPoint{ x1, y1 }; vs[2].tex_coord = SDL_FPoint{ u1, v1 };
+		vs[3].position = SDL_FPoint{ x0, y1 }; vs[3].tex_coord = SDL_FPoint{ u0, v1 };
+		vs[0].color = vs[1].color = vs[2].color = vs[3].color = tint_vertex;
+
+		// all glyphs of a run share the same depth, so they are never sorted apart
+		itu_lib_render_queue_push_quad(layer, origin.y, atlas, vs);
+	}
+}
+
+// returns the size (in pixels) of the text rect
+vec2f itu_lib_text_measure(SDLContext* context, TTF_Font* font, float size, const char* text)
+{
+	ITU_TextRun* run = itu_lib_text_run_get(context, font, size, text);
+	return run ? run->size : VEC2F_ZERO;
+}
+
+// forgets all laid out runs (atlases are kept)
+void itu_lib_text_clear_cache()
+{
+	stbds_hmfree(ctx_text.runs_lookup);
+	stbds_arrsetlen(ctx_text.runs, 0);
+	stbds_arrsetlen(ctx_text.run_glyphs, 0);
+	stbds_arrsetlen(ctx_text.run_strings, 0);
+	ctx_text.stats.runs_count = 0;
+}
+
+// frees everything, including atlases
+// NOTE: must be called before closing fonts used for text, since faces are identified by font pointer
+void itu_lib_text_free()
+{
+	itu_lib_text_clear_cache();
+	stbds_arrfree(ctx_text.runs);
+	stbds_arrfree(ctx_text.run_glyphs);
+	stbds_arrfree(ctx_text.run_strings);
+
+	for(int i = 0; i < stbds_arrlen(ctx_text.faces); ++i)
+	{
+		ITU_TextFace* face = ctx_text.faces[i];
+		SDL_DestroyTexture(face->atlas);
+		stbds_hmfree(face->glyphs);
+		SDL_free(face);
+	}
+	stbds_arrfree(ctx_text.faces);
+
+	SDL_zero(ctx_text.stats);
+}
+
+SDL_Texture* itu_lib_text_get_atlas(SDLContext* context, TTF_Font* font, float size)
+{
+	ITU_TextFace* face = itu_lib_text_face_get(context, font, size);
+	return face ? face->atlas : NULL;
+}
+
+ITU_TextStats itu_lib_text_get_stats()
+{
+	ITU_TextStats ret = ctx_text.stats;
+	ctx_text.stats.runs_built = 0;
+	return ret;
+}
+
+#endif // (defined ITU_LIB_TEXT_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
@@ -0,0 +1,342 @@
+// itu_lib_tilemap.hpp
+// chunked tilemap renderer
+// the map is split in chunks of TILEMAP_CHUNK_SIZE x TILEMAP_CHUNK_SIZE tiles, each baked (once) in its own render target.
+// Rendering the map is then a single textured quad per visible chunk, so the cost depends on how much of the map
+// is on screen and not on the size of the map. Chunks are baked lazily the first time they are visible, and rebaked
+// only when one of their tiles change
+//
+// coordinates follow the same conventions as the rest of the engine:
+// - tiles are stored row by row, with the y-axis pointing up (row 0 is the bottom one)
+// - `Transform.position` is the world position of the CENTER of tile (0, 0)
+// - a tile is `scale * tile_size / TEXTURE_PIXELS_PER_UNIT` world units wide
+//
+// limitations
+// - `Transform.rotation` is ignored, and scale is assumed to be positive
+// - baked chunks live in render targets, which can be lost (ie, `SDL_EVENT_RENDER_TARGETS_RESET`). Call
+//   `itu_lib_tilemap_invalidate()` when that happens
+// - tile data and chunks are owned by the tilemap, so `itu_lib_tilemap_free()` must be called before removing the component
+
+#ifndef ITU_LIB_TILEMAP_HPP
+#define ITU_LIB_TILEMAP_HPP
+
+#ifndef ITU_UNITY_BUILD
+#include <SDL3/SDL.h>
+#include <itu_common.hpp>
+#include <itu_lib_engine.hpp>
+#include <itu_lib_render_queue.hpp>
+#endif
+
+#ifndef TILEMAP_CHUNK_SIZE
+#define TILEMAP_CHUNK_SIZE 32
+#endif
+
+#define TILEMAP_TILE_EMPTY 0xFFFF
+
+struct ITU_TilemapChunk
+{
+	SDL_Texture* texture; // NULL until first baked
+	bool         dirty;
+};
+
+struct Tilemap
+{
+	SDL_Texture* tileset;
+	int          tileset_cols;
+	int          tile_size;    // size of a tile in the tileset, in pixels
+	Uint8        layer;        // render queue layer (lower layers are drawn first)
+
+	int     cols;
+	int     rows;
+	Uint16* tiles;             // tile index in the tileset (row by row), or TILEMAP_TILE_EMPTY
+
+	int               chunks_cols;
+	int               chunks_rows;
+	ITU_TilemapChunk* chunks;
+};
+
+void   itu_lib_tilemap_init(Tilemap* tilemap, SDL_Texture* tileset, int tileset_cols, int tile_size, int cols, int rows);
+void   itu_lib_tilemap_free(Tilemap* tilemap);
+void   itu_lib_tilemap_invalidate(Tilemap* tilemap);
+void   itu_lib_tilemap_set_tile(Tilemap* tilemap, int x, int y, Uint16 tile);
+void   itu_lib_tilemap_set_tiles(Tilemap* tilemap, Uint16* tiles);
+Uint16 itu_lib_tilemap_get_tile(Tilemap* tilemap, int x, int y);
+
+vec2f     itu_lib_tilemap_get_tile_world_size(Tilemap* tilemap, Transform* transform);
+SDL_FRect itu_lib_tilemap_get_tile_rect(Tilemap* tilemap, Transform* transform, int x, int y);
+SDL_FRect itu_lib_tilemap_get_tile_rect_src(Tilemap* tilemap, Uint16 tile);
+
+void itu_lib_tilemap_render(SDLContext* context, Tilemap* tilemap, Transform* transform);
+void itu_lib_tilemap_queue(SDLContext* context, Tilemap* tilemap, Transform* transform);
+
+#endif // ITU_LIB_TILEMAP_HPP
+
+#if (defined ITU_LIB_TILEMAP_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
+
+// allocates tile and chunk data. All tiles start empty
+void itu_lib_tilemap_init(Tilemap* tilemap, SDL_Texture* tileset, int tileset_cols, int tile_size, int cols, int rows)
+{
+	SDL_assert(cols > 0 && rows > 0);
+
+	tilemap->tileset = tileset;
+	tilemap->tileset_cols = tileset_cols;
+	tilemap->tile_size = tile_size;
+	tilemap->layer = 0;
+
+	tilemap->cols = cols;
+	tilemap->rows = rows;
+	tilemap->tiles = (Uint16*)SDL_malloc(sizeof(Uint16) * cols * rows);
+	for(int i = 0; i < cols * rows; ++i)
+		tilemap->tiles[i] = TILEMAP_TILE_EMPTY;
+
+	tilemap->chunks_cols = (cols + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+	tilemap->chunks_rows = (rows + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+	tilemap->chunks = (ITU_TilemapChunk*)SDL_calloc(tilemap->chunks_cols * tilemap->chunks_rows, sizeof(ITU_TilemapChunk));
+	itu_lib_tilemap_invalidate(tilemap);
+}
+
+void itu_lib_tilemap_free(Tilemap* tilemap)
+{
+	for(int i = 0; i < tilemap->chunks_cols * tilemap->chunks_rows; ++i)
+		if(tilemap->chunks[i].texture)
+			SDL_DestroyTexture(tilemap->chunks[i].texture);
+
+	SDL_free(tilemap->chunks);
+	SDL_free(tilemap->tiles);
+	*tilemap = { 0 };
+}
+
+// forces all chunks to be baked again next time they are visible
+void itu_lib_tilemap_invalidate(Tilemap* tilemap)
+{
+	for(int i = 0; i < tilemap->chunks_cols * tilemap->chunks_rows; ++i)
+		tilemap->chunks[i].dirty = true;
+}
+
+void itu_lib_tilemap_set_tile(Tilemap* tilemap, int x, int y, Uint16 tile)
+{
+	SDL_assert(x >= 0 && x < tilemap->cols && y >= 0 && y < tilemap->rows);
+
+	Uint16* dst = &tilemap->tiles[y * tilemap->cols + x];
+	if(*dst == tile)
+		return;
+
+	*dst = tile;
+	tilemap->chunks[(y / TILEMAP_CHUNK_SIZE) * tilemap->chunks_cols + x / TILEMAP_CHUNK_SIZE].dirty = true;
+}
+
+// replaces the whole map. `tiles` must hold `cols * rows` elements
+void itu_lib_tilemap_set_tiles(Tilemap* tilemap, Uint16* tiles)
+{
+	SDL_memcpy(tilemap->tiles, tiles, sizeof(Uint16) * tilemap->cols * tilemap->rows);
+	itu_lib_tilemap_invalidate(tilemap);
+}
+
+Uint16 itu_lib_tilemap_get_tile(Tilemap* tilemap, int x, int y)
+{
+	if(x < 0 || x >= tilemap->cols || y < 0 || y >= tilemap->rows)
+		return TILEMAP_TILE_EMPTY;
+	return tilemap->tiles[y * tilemap->cols + x];
+}
+
+vec2f itu_lib_tilemap_get_tile_world_size(Tilemap* tilemap, Transform* transform)
+{
+	vec2f ret;
+	ret.x = transform->scale.x * tilemap->tile_size / (float)TEXTURE_PIXELS_PER_UNIT;
+	ret.y = transform->scale.y * tilemap->tile_size / (float)TEXTURE_PIXELS_PER_UNIT;
+	return ret;
+}
+
+// world-space rect of the given tile (`x` and `y` are the bottom-left corner)
+SDL_FRect itu_lib_tilemap_get_tile_rect(Tilemap* tilemap, Transform* transform, int x, int y)
+{
+	vec2f tile_size = itu_lib_tilemap_get_tile_world_size(tilemap, transform);
+
+	SDL_FRect ret;
+	ret.x = transform->position.x + tile_size.x * (x - 0.5f);
+	ret.y = transform->position.y + tile_size.y * (y - 0.5f);
+	ret.w = tile_size.x;
+	ret.h = tile_size.y;
+	return ret;
+}
+
+// source rect of the given tile in the tileset
+SDL_FRect itu_lib_tilemap_get_tile_rect_src(Tilemap* tilemap, Uint16 tile)
+{
+	SDL_FRect ret;
+	ret.x = (float)((tile % tilemap->tileset_cols) * tilemap->tile_size);
+	ret.y = (float)((tile / tilemap->tileset_cols) * tilemap->tile_size);
+	ret.w = (float)tilemap->tile_size;
+	ret.h = (float)tilemap->tile_size;
+	return ret;
+}
+
+// world-space rect covered by the given chunk (last row/column of chunks can be smaller than the others)
+static SDL_FRect itu_lib_tilemap_get_chunk_rect(Tilemap* tilemap, Transform* transform, int chunk_x, int chunk_y)
+{
+	int tile_x = chunk_x * TILEMAP_CHUNK_SIZE;
+	int tile_y = chunk_y * TILEMAP_CHUNK_SIZE;
+	int tiles_w = SDL_min(TILEMAP_CHUNK_SIZE, tilemap->cols - tile_x);
+	int tiles_h = SDL_min(TILEMAP_CHUNK_SIZE, tilemap->rows - tile_y);
+
+	SDL_FRect ret = itu_lib_tilemap_get_tile_rect(tilemap, transform, tile_x, tile_y);
+	ret.w *= tiles_w;
+	ret.h *= tiles_h;
+	return ret;
+}
+
+// computes the (inclusive) range of chunks overlapping the active camera
+// returns false if no chunk is visible
+static bool itu_lib_tilemap_get_visible_chunks(SDLContext* context, Tilemap* tilemap, Transform* transform, int* out_min_x, int* out_min_y, int* out_max_x, int* out_max_y)
+{
+	vec2f tile_size = itu_lib_tilemap_get_tile_world_size(tilemap, transform);
+	vec2f chunk_size = tile_size * (float)TILEMAP_CHUNK_SIZE;
+	vec2f origin = transform->position - tile_size * 0.5f;
+
+	SDL_FRect view = camera_get_world_rect(context, context->camera_active);
+
+	// NOTE: the grid is regular, so we can compute the visible range directly instead of testing every chunk
+	int min_x = (int)SDL_floorf((view.x          - origin.x) / chunk_size.x);
+	int min_y = (int)SDL_floorf((view.y          - origin.y) / chunk_size.y);
+	int max_x = (int)SDL_floorf((view.x + view.w - origin.x) / chunk_size.x);
+	int max_y = (int)SDL_floorf((view.y + view.h - origin.y) / chunk_size.y);
+
+	if(max_x < 0 || max_y < 0 || min_x >= tilemap->chunks_cols || min_y >= tilemap->chunks_rows)
+		return false;
+
+	*out_min_x = SDL_max(min_x, 0);
+	*out_min_y = SDL_max(min_y, 0);
+	*out_max_x = SDL_min(max_x, tilemap->chunks_cols - 1);
+	*out_max_y = SDL_min(max_y, tilemap->chunks_rows - 1);
+	return true;
+}
+
+// renders all tiles of the chunk in its render target (creating it if needed)
+static void itu_lib_tilemap_chunk_bake(SDLContext* context, Tilemap* tilemap, int chunk_x, int chunk_y)
+{
+	ITU_TilemapChunk* chunk = &tilemap->chunks[chunk_y * tilemap->chunks_cols + chunk_x];
+
+	int tile_x = chunk_x * TILEMAP_CHUNK_SIZE;
+	int tile_y = chunk_y * TILEMAP_CHUNK_SIZE;
+	int tiles_w = SDL_min(TILEMAP_CHUNK_SIZE, tilemap->cols - tile_x);
+	int tiles_h = SDL_min(TILEMAP_CHUNK_SIZE, tilemap->rows - tile_y);
+
+	if(!chunk->texture)
+	{
+		chunk->texture = SDL_CreateTexture(context->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, tiles_w * tilemap->tile_size, tiles_h * tilemap->tile_size);
+		if(!chunk->texture)
+		{
+			SDL_Log("WARNING can't create tilemap chunk: %s\n", SDL_GetError());
+			return;
+		}
+
+		// chunks are sampled the same way the tileset would be (ie, pixel art stays crisp)
+		SDL_ScaleMode scale_mode;
+		SDL_GetTextureScaleMode(tilemap->tileset, &scale_mode);
+		SDL_SetTextureScaleMode(chunk->texture, scale_mode);
+		// tiles are drawn with regular alpha blending on a transparent texture, so the chunk content ends up premultiplied
+		SDL_SetTextureBlendMode(chunk->texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+	}
+
+	SDL_Texture* target_prev = SDL_GetRenderTarget(context->renderer);
+	float r, g, b, a;
+	SDL_GetRenderDrawColorFloat(context->renderer, &r, &g, &b, &a);
+
+	// NOTE: render scale and viewport are per-target, so whatever the caller set on the window is not applied here
+	SDL_SetRenderTarget(context->renderer, chunk->texture);
+	SDL_SetRenderDrawColorFloat(context->renderer, 0, 0, 0, 0);
+	SDL_RenderClear(context->renderer);
+
+	sdl_set_texture_tint(tilemap->tileset, COLOR_WHITE);
+	for(int y = 0; y < tiles_h; ++y)
+	{
+		for(int x = 0; x < tiles_w; ++x)
+		{
+			Uint16 tile = tilemap->tiles[(tile_y + y) * tilemap->cols + tile_x + x];
+			if(tile == TILEMAP_TILE_EMPTY)
+				continue;
+
+			SDL_FRect rect_src = itu_lib_tilemap_get_tile_rect_src(tilemap, tile);
+
+			// texture y-axis points down, tilemap y-axis points up
+			SDL_FRect rect_dst;
+			rect_dst.x = (float)(x * tilemap->tile_size);
+			rect_dst.y = (float)((tiles_h - 1 - y) * tilemap->tile_size);
+			rect_dst.w = (float)tilemap->tile_size;
+			rect_dst.h = (float)tilemap->tile_size;
+
+			SDL_RenderTexture(context->renderer, tilemap->tileset, &rect_src, &rect_dst);
+		}
+	}
+
+	SDL_SetRenderTarget(context->renderer, target_prev);
+	SDL_SetRenderDrawColorFloat(context->renderer, r, g, b, a);
+
+	chunk->dirty = false;
+}
+
+// bakes the chunk if needed, and returns its texture (NULL if it can't be drawn)
+static SDL_Texture* itu_lib_tilemap_chunk_prepare(SDLContext* context, Tilemap* tilemap, int chunk_x, int chunk_y)
+{
+	ITU_TilemapChunk* chunk = &tilemap->chunks[chunk_y * tilemap->chunks_cols + chunk_x];
+	if(chunk->dirty)
+		itu_lib_tilemap_chunk_bake(context, tilemap, chunk_x, chunk_y);
+	return chunk->texture;
+}
+
+// draws all visible chunks immediately
+void itu_lib_tilemap_render(SDLContext* context, Tilemap* tilemap, Transform* transform)
+{
+	int min_x, min_y, max_x, max_y;
+	if(!itu_lib_tilemap_get_visible_chunks(context, tilemap, transform, &min_x, &min_y, &max_x, &max_y))
+		return;
+
+	for(int chunk_y = min_y; chunk_y <= max_y; ++chunk_y)
+	{
+		for(int chunk_x = min_x; chunk_x <= max_x; ++chunk_x)
+		{
+			SDL_Texture* texture = itu_lib_tilemap_chunk_prepare(context, tilemap, chunk_x, chunk_y);
+			if(!texture)
+				continue;
+
+			SDL_FRect rect_dst = rect_global_to_screen(context, itu_lib_tilemap_get_chunk_rect(tilemap, transform, chunk_x, chunk_y));
+			SDL_RenderTexture(context->renderer, texture, NULL, &rect_dst);
+		}
+	}
+}
+
+// pushes all visible chunks in the render queue, using the tilemap layer and the screen-space bottom of each chunk as depth
+void itu_lib_tilemap_queue(SDLContext* context, Tilemap* tilemap, Transform* transform)
+{
+	int min_x, min_y, max_x, max_y;
+	if(!itu_lib_tilemap_get_visible_chunks(context, tilemap, transform, &min_x, &min_y, &max_x, &max_y))
+		return;
+
+	const SDL_FColor white = { 1, 1, 1, 1 };
+
+	for(int chunk_y = min_y; chunk_y <= max_y; ++chunk_y)
+	{
+		for(int chunk_x = min_x; chunk_x <= max_x; ++chunk_x)
+		{
+			SDL_Texture* texture = itu_lib_tilemap_chunk_prepare(context, tilemap, chunk_x, chunk_y);
+			if(!texture)
+				continue;
+
+			SDL_FRect rect_dst = rect_global_to_screen(context, itu_lib_tilemap_get_chunk_rect(tilemap, transform, chunk_x, chunk_y));
+
+			SDL_Vertex vs[4];
+			vs[0].position = SDL_FPoint{ rect_dst.x             , rect_dst.y              }; // top left
+			vs[1].position = SDL_FPoint{ rect_dst.x + rect_dst.w, rect_dst.y              }; // top right
+			vs[2].position = SDL_FPoint{ rect_dst.x + rect_dst.w, rect_dst.y + rect_dst.h }; // bottom right
+			vs[3].position = SDL_FPoint{ rect_dst.x             , rect_dst.y + rect_dst.h }; // bottom left
+			vs[0].tex_coord = SDL_FPoint{ 0, 0 };
+			vs[1].tex_coord = SDL_FPoint{ 1, 0 };
+			vs[2].tex_coord = SDL_FPoint{ 1, 1 };
+			vs[3].tex_coord = SDL_FPoint{ 0, 1 };
+			vs[0].color = vs[1].color = vs[2].color = vs[3].color = white;
+
+			itu_lib_render_queue_push_quad(tilemap->layer, rect_dst.y + rect_dst.h, texture, vs);
+		}
+	}
+}
+
+#endif // (defined ITU_LIB_TILEMAP_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
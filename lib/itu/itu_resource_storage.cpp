@@ -6,9 +6,15 @@
 #include <SDL3_mixer/SDL_mixer.h>
 #include <SDL3_ttf/SDL_ttf.h>
 #include <stb_ds.h>
+#include <stb_image.h>
 #include <imgui/imgui.h>
 #endif
 
+// NOTE: imgui compiles its own (static) copy in a different translation unit
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imgui/imstb_rectpack.h>
+
 
 struct TextureData
 {
@@ -27,6 +33,32 @@ struct FontData
 };
 static ITU_IdTexture id_font_next;
 
+// image waiting to be packed in the atlas (pixels are RGBA32, owned)
+struct AtlasImage
+{
+	unsigned char* pixels;
+	int w;
+	int h;
+};
+
+// sprite waiting to be packed in the atlas
+struct AtlasPending
+{
+	ITU_IdSprite id;
+	int          image;
+	SDL_Rect     rect;
+};
+
+struct AtlasSprite
+{
+	int       page;  // -1 until the atlas is built
+	SDL_FRect rect;  // in pixels, inside the page
+};
+
+// space around each sprite inside an atlas page, filled by extruding the sprite border
+// (avoids bleeding of neighbour sprites when using linear filtering)
+#define ATLAS_PADDING 1
+
 struct ITU_ResourceStorageContext
 {
 	stbds_hm(ITU_IdTexture, TextureData) storage_texture;
@@ -36,6 +68,12 @@ struct ITU_ResourceStorageContext
 	stbds_hm(ITU_IdTexture, const char*) debug_names_texture;
 	stbds_hm(ITU_IdAudio  , const char*) debug_names_audio;
 	stbds_hm(ITU_IdFont   , const char*) debug_names_font;
+
+	stbds_arr(AtlasImage)                atlas_images;
+	stbds_arr(AtlasPending)              atlas_pending;
+	stbds_hm(ITU_IdSprite, AtlasSprite)  atlas_sprites;
+	stbds_arr(ITU_IdTexture)             atlas_pages;
+	ITU_IdSprite                         atlas_id_next;
 };
 ITU_ResourceStorageContext ctx_rstorage;
 
@@ -110,6 +148,220 @@ const char* itu_sys_rstorage_texture_get_debug_name(ITU_IdTexture id)
 	return ctx_rstorage.debug_names_texture[name_loc].value;
 }
 
+// =====================================================================================
+// atlas
+// =====================================================================================
+
+static int itu_sys_rstorage_atlas_load_image(const char* path)
+{
+	AtlasImage image;
+	int n;
+	image.pixels = stbi_load(path, &image.w, &image.h, &n, 4);
+	if(!image.pixels)
+	{
+		SDL_Log("Invalid or not supported texture file '%s'", path);
+		return -1;
+	}
+
+	stbds_arrput(ctx_rstorage.atlas_images, image);
+	return stbds_arrlen(ctx_rstorage.atlas_images) - 1;
+}
+
+static ITU_IdSprite itu_sys_rstorage_atlas_add_pending(int image, SDL_Rect rect)
+{
+	ITU_IdSprite id = ctx_rstorage.atlas_id_next++;
+
+	AtlasPending pending;
+	pending.id = id;
+	pending.image = image;
+	pending.rect = rect;
+	stbds_arrput(ctx_rstorage.atlas_pending, pending);
+
+	AtlasSprite sprite = { 0 };
+	sprite.page = -1;
+	stbds_hmput(ctx_rstorage.atlas_sprites, id, sprite);
+
+	return id;
+}
+
+ITU_IdSprite itu_sys_rstorage_atlas_add_image(const char* path)
+{
+	int image = itu_sys_rstorage_atlas_load_image(path);
+	if(image == -1)
+		return -1;
+
+	SDL_Rect rect = { 0, 0, ctx_rstorage.atlas_images[image].w, ctx_rstorage.atlas_images[image].h };
+	return itu_sys_rstorage_atlas_add_pending(image, rect);
+}
+
+// adds a sprite for each of the given sub-rects of the image (useful for tilesheets)
+// NOTE: rects that are empty or not fully inside the image are rejected (their id is -1)
+void itu_sys_rstorage_atlas_add_subimages(const char* path, SDL_Rect* rects, int rects_count, ITU_IdSprite* out_ids)
+{
+	int image = itu_sys_rstorage_atlas_load_image(path);
+	for(int i = 0; i < rects_count; ++i)
+	{
+		out_ids[i] = -1;
+		if(image == -1)
+			continue;
+
+		AtlasImage* atlas_image = &ctx_rstorage.atlas_images[image];
+		SDL_Rect rect = rects[i];
+		if(rect.w <= 0 || rect.h <= 0 || rect.x < 0 || rect.y < 0 || rect.x + rect.w > atlas_image->w || rect.y + rect.h > atlas_image->h)
+		{
+			SDL_Log("WARNING sub-rect %d (%d %d %d %d) is outside of '%s' (%dx%d), skipped\n", i, rect.x, rect.y, rect.w, rect.h, path, atlas_image->w, atlas_image->h);
+			continue;
+		}
+
+		out_ids[i] = itu_sys_rstorage_atlas_add_pending(image, rect);
+	}
+}
+
+// copies the sub-rect of the image in the page, extruding its borders into the padding
+static void itu_sys_rstorage_atlas_blit(unsigned char* page_pixels, int dst_x, int dst_y, AtlasImage* image, SDL_Rect src)
+{
+	SDL_assert(src.x >= 0 && src.y >= 0 && src.x + src.w <= image->w && src.y + src.h <= image->h);
+	for(int y = -ATLAS_PADDING; y < src.h + ATLAS_PADDING; ++y)
+	{
+		int src_y = src.y + SDL_clamp(y, 0, src.h - 1);
+		for(int x = -ATLAS_PADDING; x < src.w + ATLAS_PADDING; ++x)
+		{
+			int src_x = src.x + SDL_clamp(x, 0, src.w - 1);
+			Uint32* dst_pixel = (Uint32*)(page_pixels + ((dst_y + y) * ATLAS_PAGE_SIZE + (dst_x + x)) * 4);
+			Uint32* src_pixel = (Uint32*)(image->pixels + (src_y * image->w + src_x) * 4);
+			*dst_pixel = *src_pixel;
+		}
+	}
+}
+
+void itu_sys_rstorage_atlas_build(SDLContext* context, SDL_ScaleMode mode)
+{
+	int pending_count = stbds_arrlen(ctx_rstorage.atlas_pending);
+	if(pending_count == 0)
+		return;
+
+	stbrp_rect* rects = (stbrp_rect*)SDL_calloc(pending_count, sizeof(stbrp_rect));
+	stbrp_node* nodes = (stbrp_node*)SDL_malloc(sizeof(stbrp_node) * ATLAS_PAGE_SIZE);
+	unsigned char* page_pixels = (unsigned char*)SDL_malloc(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4);
+
+	int rects_count = 0;
+	for(int i = 0; i < pending_count; ++i)
+	{
+		AtlasPending* pending = &ctx_rstorage.atlas_pending[i];
+		int w = pending->rect.w + ATLAS_PADDING * 2;
+		int h = pending->rect.h + ATLAS_PADDING * 2;
+		if(w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE)
+		{
+			SDL_Log("WARNING sprite %d is too big for the atlas (%dx%d)\n", pending->id, pending->rect.w, pending->rect.h);
+			continue;
+		}
+
+		stbrp_rect* rect = &rects[rects_count++];
+		rect->id = i;
+		rect->w = w;
+		rect->h = h;
+	}
+
+	// fill one page at a time, until everything is packed
+	int rects_left = rects_count;
+	while(rects_left > 0)
+	{
+		stbrp_context packer;
+		stbrp_init_target(&packer, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, nodes, ATLAS_PAGE_SIZE);
+		stbrp_pack_rects(&packer, rects, rects_left);
+
+		SDL_memset(page_pixels, 0, ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4);
+		int page = stbds_arrlen(ctx_rstorage.atlas_pages);
+		int packed_count = 0;
+		for(int i = 0; i < rects_left; ++i)
+		{
+			stbrp_rect* rect = &rects[i];
+			if(!rect->was_packed)
+				continue;
+
+			AtlasPending* pending = &ctx_rstorage.atlas_pending[rect->id];
+			itu_sys_rstorage_atlas_blit(page_pixels, rect->x + ATLAS_PADDING, rect->y + ATLAS_PADDING, &ctx_rstorage.atlas_images[pending->image], pending->rect);
+
+			AtlasSprite* sprite = &stbds_hmgetp(ctx_rstorage.atlas_sprites, pending->id)->value;
+			sprite->page = page;
+			sprite->rect.x = rect->x + ATLAS_PADDING;
+			sprite->rect.y = rect->y + ATLAS_PADDING;
+			sprite->rect.w = pending->rect.w;
+			sprite->rect.h = pending->rect.h;
+			packed_count++;
+		}
+
+		SDL_Surface* surface = SDL_CreateSurfaceFrom(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, SDL_PIXELFORMAT_RGBA32, page_pixels, ATLAS_PAGE_SIZE * 4);
+		SDL_Texture* texture = surface ? SDL_CreateTextureFromSurface(context->renderer, surface) : NULL;
+		SDL_DestroySurface(surface);
+
+		if(texture)
+		{
+			SDL_SetTextureScaleMode(texture, mode);
+
+			ITU_IdTexture id_texture = itu_sys_rstorage_texture_add(texture);
+			stbds_arrput(ctx_rstorage.atlas_pages, id_texture);
+#ifdef ENABLE_DIAGNOSTICS
+			char debug_name[32];
+			SDL_snprintf(debug_name, 32, "atlas page %d", page);
+			itu_sys_rstorage_texture_set_debug_name(id_texture, debug_name);
+#endif
+		}
+		else
+		{
+			// the sprites of this page stay unresolved (`itu_sys_rstorage_sprite_get()` returns false for them)
+			SDL_Log("WARNING failed to create atlas page %d: %s\n", page, SDL_GetError());
+			for(int i = 0; i < rects_left; ++i)
+				if(rects[i].was_packed)
+					stbds_hmgetp(ctx_rstorage.atlas_sprites, ctx_rstorage.atlas_pending[rects[i].id].id)->value.page = -1;
+		}
+
+		// move rects that didn't fit at the front, for the next page
+		int rects_left_new = 0;
+		for(int i = 0; i < rects_left; ++i)
+			if(!rects[i].was_packed)
+				rects[rects_left_new++] = rects[i];
+		rects_left = rects_left_new;
+	}
+
+	SDL_free(rects);
+	SDL_free(nodes);
+	SDL_free(page_pixels);
+
+	// everything queued so far is now in GPU memory, we don't need CPU copies anymore
+	for(int i = 0; i < stbds_arrlen(ctx_rstorage.atlas_images); ++i)
+		stbi_image_free(ctx_rstorage.atlas_images[i].pixels);
+	stbds_arrsetlen(ctx_rstorage.atlas_images, 0);
+	stbds_arrsetlen(ctx_rstorage.atlas_pending, 0);
+}
+
+// resolves a sprite handle into its page texture and its rect (in pixels) inside that page
+bool itu_sys_rstorage_sprite_get(ITU_IdSprite id, SDL_Texture** out_texture, SDL_FRect* out_rect)
+{
+	int loc = stbds_hmgeti(ctx_rstorage.atlas_sprites, id);
+	if(loc == -1 || ctx_rstorage.atlas_sprites[loc].value.page == -1)
+		return false;
+
+	AtlasSprite* sprite = &ctx_rstorage.atlas_sprites[loc].value;
+	*out_texture = itu_sys_rstorage_texture_get_ptr(ctx_rstorage.atlas_pages[sprite->page]);
+	*out_rect = sprite->rect;
+	return true;
+}
+
+// same as `itu_sys_rstorage_sprite_get()`, but the rect is in normalized texture coordinates
+bool itu_sys_rstorage_sprite_get_uv(ITU_IdSprite id, SDL_Texture** out_texture, SDL_FRect* out_uv)
+{
+	SDL_FRect rect;
+	if(!itu_sys_rstorage_sprite_get(id, out_texture, &rect))
+		return false;
+
+	out_uv->x = rect.x / ATLAS_PAGE_SIZE;
+	out_uv->y = rect.y / ATLAS_PAGE_SIZE;
+	out_uv->w = rect.w / ATLAS_PAGE_SIZE;
+	out_uv->h = rect.h / ATLAS_PAGE_SIZE;
+	return true;
+}
+
 // =====================================================================================
 // fonts
 // =====================================================================================
@@ -8,6 +8,12 @@
 typedef Uint32 ITU_IdTexture;
 typedef Uint32 ITU_IdAudio;
 typedef Uint32 ITU_IdFont;
+typedef Uint32 ITU_IdSprite;
+
+// size (in pixels) of each atlas page
+#ifndef ATLAS_PAGE_SIZE
+#define ATLAS_PAGE_SIZE 2048
+#endif
 
 ITU_IdTexture itu_sys_rstorage_texture_load(SDLContext* context, const char* path, SDL_ScaleMode mode);
 ITU_IdTexture itu_sys_rstorage_texture_add(SDL_Texture* texture);
@@ -16,6 +22,16 @@ SDL_Texture*  itu_sys_rstorage_texture_get_ptr(ITU_IdTexture id);
 void          itu_sys_rstorage_texture_set_debug_name(ITU_IdTexture id, const char* debug_name);
 const char*   itu_sys_rstorage_texture_get_debug_name(ITU_IdTexture id);
 
+// texture atlas
+// images (or sub-rects of images) are queued with `atlas_add_*`, which immediately returns a stable sprite handle.
+// `atlas_build` packs everything queued so far into as few pages as possible, and handles can then be resolved
+// NOTE: building again only packs what was added after the previous build (in new pages), so already resolved
+//       page textures stay valid
+ITU_IdSprite itu_sys_rstorage_atlas_add_image(const char* path);
+void         itu_sys_rstorage_atlas_add_subimages(const char* path, SDL_Rect* rects, int rects_count, ITU_IdSprite* out_ids);
+void         itu_sys_rstorage_atlas_build(SDLContext* context, SDL_ScaleMode mode);
+bool         itu_sys_rstorage_sprite_get(ITU_IdSprite id, SDL_Texture** out_texture, SDL_FRect* out_rect);
+bool         itu_sys_rstorage_sprite_get_uv(ITU_IdSprite id, SDL_Texture** out_texture, SDL_FRect* out_uv);
 
 ITU_IdFont  itu_sys_rstorage_font_load(SDLContext* context, const char* path, float size);
 ITU_IdFont  itu_sys_rstorage_font_add(TTF_Font* font);
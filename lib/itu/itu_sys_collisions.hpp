@@ -0,0 +1,763 @@
+// itu_sys_collisions.hpp
+// lightweight kinematic collision system, an alternative to `itu_sys_physics` for games that only need
+// things to not overlap (top-down games, bullet hells, crowds). No velocities, no mass, no box2d.
+//
+// every frame, for all entities with a `Transform` and a `Collider`:
+// 1. broadphase: colliders' AABBs are binned in a uniform grid (rebuilt from scratch in the frame arena),
+//    pairs sharing a cell are filtered with `itu_lib_overlaps_rect_rect()`
+// 2. narrowphase: a manifold (normal + depth) is computed for each candidate pair
+// 3. separation: overlapping colliders are pushed apart, iterating a few times over all contacts so that
+//    stacks and crowds settle down (same idea of `collision_separate()` in ES02, just repeated)
+//
+// important notes:
+// - this only fixes positions. Games move their entities however they want, and the system puts them back
+//   where they don't overlap anything (so there's no tunneling protection: fast things can pass through thin things)
+// - `COLLIDER_RECT` is always axis aligned, use `COLLIDER_POLYGON` for rotated boxes
+// - `Collider::offset` and polygon vertices rotate with the transform, scale is ignored
+// - polygons must be convex (any winding order)
+// - performance depends on the cell size, which should be around twice the size of the most common collider.
+//   Colliders much bigger than a cell are fine, but they are added to every cell they touch
+
+#ifndef ITU_SYS_COLLISIONS_HPP
+#define ITU_SYS_COLLISIONS_HPP
+
+#ifndef ITU_UNITY_BUILD
+#include <itu_lib_engine.hpp>
+#include <itu_lib_overlaps.hpp>
+#endif
+
+// world units
+#ifndef COLLISIONS_CELL_SIZE
+#define COLLISIONS_CELL_SIZE 1.0f
+#endif
+
+// number of times contacts are solved each frame. More iterations means stacks and crowds settle faster
+#ifndef COLLISIONS_ITERATIONS
+#define COLLISIONS_ITERATIONS 4
+#endif
+
+#define COLLIDER_POLYGON_VERTICES_MAX 8
+
+enum ColliderType
+{
+	COLLIDER_CIRCLE,
+	COLLIDER_RECT,
+	COLLIDER_POLYGON,
+};
+
+struct Collider
+{
+	ColliderType type;
+	vec2f offset;  // from the entity's position
+	union
+	{
+		float radius;    // COLLIDER_CIRCLE
+		vec2f half_size; // COLLIDER_RECT
+		struct
+		{
+			vec2f vertices[COLLIDER_POLYGON_VERTICES_MAX];
+			int vertices_count;
+		} polygon;       // COLLIDER_POLYGON
+	};
+	bool is_static; // never moved by the system (walls, obstacles)
+	bool is_sensor; // reports contacts, but is never separated from anything
+};
+
+// contact between two colliders, valid until the next run of the system
+// `normal` goes from `a` to `b`
+struct CollisionContact
+{
+	ITU_EntityId a;
+	ITU_EntityId b;
+	vec2f normal;
+	float depth; // before separation
+	bool is_sensor;
+};
+
+struct CollisionsStats
+{
+	int colliders_count;
+	int cells_entries_count; // each collider is counted once for every cell it touches
+	int pairs_tested_count;  // pairs that passed the broadphase
+	int contacts_count;
+	float update_ms;
+};
+
+Collider itu_sys_collisions_make_circle(float radius, vec2f offset = VEC2F_ZERO);
+Collider itu_sys_collisions_make_rect(vec2f half_size, vec2f offset = VEC2F_ZERO);
+Collider itu_sys_collisions_make_polygon(const vec2f* vertices, int vertices_count, vec2f offset = VEC2F_ZERO);
+
+void itu_sys_collisions_set_cell_size(float cell_size);
+CollisionContact* itu_sys_collisions_get_contacts(int* out_count);
+CollisionsStats itu_sys_collisions_get_stats();
+
+void itu_sys_collisions_debug_draw(SDLContext* context);
+
+void itu_system_collisions(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count);
+
+#endif // ITU_SYS_COLLISIONS_HPP
+
+#if (defined ITU_SYS_COLLISIONS_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
+
+// collider in world space
+// circles are (center, radius), rects are (center, half_size), polygons own their range of world vertices
+struct CollisionsShape
+{
+	ColliderType type;
+	vec2f center;
+	vec2f half_size;
+	float radius;
+	vec2f* vertices;
+	int vertices_count;
+};
+
+// entry of the broadphase grid
+// NOTE: different cells can end up in the same bucket, so we need the cell coordinates too
+// NOTE: the AABB is copied in every entry, so that rejecting pairs only touches contiguous memory
+struct CollisionsCellEntry
+{
+	vec2f aabb_min;
+	vec2f aabb_max;
+	int collider;
+	int cell_x;
+	int cell_y;
+	bool is_static;
+};
+
+// contact to be solved, between colliders of the current run (indices in the arrays passed to the system)
+// static colliders don't move, dynamic ones split the correction evenly
+struct CollisionsPair
+{
+	int a;
+	int b;
+	vec2f normal;
+	float depth;
+	float share_a;
+	float share_b;
+};
+
+struct SysCollisions
+{
+	float cell_size;
+
+	stbds_arr(CollisionsPair) pairs;
+	stbds_arr(CollisionContact) contacts;
+
+	// colliders of the last run, for debug draw
+	stbds_arr(ITU_EntityId) entities;
+
+	CollisionsStats stats;
+};
+
+static SysCollisions sys_collisions_data = { COLLISIONS_CELL_SIZE };
+
+Collider itu_sys_collisions_make_circle(float radius, vec2f offset)
+{
+	Collider ret;
+	SDL_zero(ret);
+	ret.type = COLLIDER_CIRCLE;
+	ret.offset = offset;
+	ret.radius = radius;
+	return ret;
+}
+
+Collider itu_sys_collisions_make_rect(vec2f half_size, vec2f offset)
+{
+	Collider ret;
+	SDL_zero(ret);
+	ret.type = COLLIDER_RECT;
+	ret.offset = offset;
+	ret.half_size = half_size;
+	return ret;
+}
+
+Collider itu_sys_collisions_make_polygon(const vec2f* vertices, int vertices_count, vec2f offset)
+{
+	Collider ret;
+	SDL_zero(ret);
+	ret.type = COLLIDER_POLYGON;
+	ret.offset = offset;
+	if(vertices_count > COLLIDER_POLYGON_VERTICES_MAX)
+	{
+		SDL_Log("WARNING polygon collider has %d vertices, only the first %d are used\n", vertices_count, COLLIDER_POLYGON_VERTICES_MAX);
+		vertices_count = COLLIDER_POLYGON_VERTICES_MAX;
+	}
+	SDL_memcpy(ret.polygon.vertices, vertices, vertices_count * sizeof(vec2f));
+	ret.polygon.vertices_count = vertices_count;
+	return ret;
+}
+
+void itu_sys_collisions_set_cell_size(float cell_size)
+{
+	SDL_assert(cell_size > 0);
+	sys_collisions_data.cell_size = cell_size;
+}
+
+CollisionContact* itu_sys_collisions_get_contacts(int* out_count)
+{
+	*out_count = (int)stbds_arrlen(sys_collisions_data.contacts);
+	return sys_collisions_data.contacts;
+}
+
+CollisionsStats itu_sys_collisions_get_stats()
+{
+	return sys_collisions_data.stats;
+}
+
+// NOTE: polygons write their vertices in `out_vertices`, which must have room for `COLLIDER_POLYGON_VERTICES_MAX`
+static void itu_sys_collisions_shape_make(Collider* collider, Transform* transform, vec2f* out_vertices, CollisionsShape* out_shape, vec2f* out_min, vec2f* out_max)
+{
+	out_shape->type = collider->type;
+	out_shape->center = transform->position + rotate(collider->offset, transform->rotation);
+	out_shape->vertices = NULL;
+	out_shape->vertices_count = 0;
+
+	switch(collider->type)
+	{
+		case COLLIDER_CIRCLE:
+		{
+			out_shape->radius = collider->radius;
+			out_shape->half_size = vec2f{ collider->radius, collider->radius };
+			*out_min = out_shape->center - out_shape->half_size;
+			*out_max = out_shape->center + out_shape->half_size;
+			break;
+		}
+		case COLLIDER_RECT:
+		{
+			out_shape->radius = 0;
+			out_shape->half_size = collider->half_size;
+			*out_min = out_shape->center - out_shape->half_size;
+			*out_max = out_shape->center + out_shape->half_size;
+			break;
+		}
+		case COLLIDER_POLYGON:
+		{
+			out_shape->radius = 0;
+			out_shape->vertices = out_vertices;
+			out_shape->vertices_count = collider->polygon.vertices_count;
+
+			*out_min = out_shape->center;
+			*out_max = out_shape->center;
+			for(int i = 0; i < collider->polygon.vertices_count; ++i)
+			{
+				vec2f v = out_shape->center + rotate(collider->polygon.vertices[i], transform->rotation);
+				out_vertices[i] = v;
+				out_min->x = SDL_min(out_min->x, v.x);
+				out_min->y = SDL_min(out_min->y, v.y);
+				out_max->x = SDL_max(out_max->x, v.x);
+				out_max->y = SDL_max(out_max->y, v.y);
+			}
+			out_shape->half_size = (*out_max - *out_min) * 0.5f;
+			break;
+		}
+	}
+}
+
+// ********************************************************************************************************************
+// manifolds
+// all of them return false if the shapes don't overlap, otherwise `out_normal` goes from `a` to `b`, and moving `b` by
+// `out_normal * out_depth` separates the two shapes
+// ********************************************************************************************************************
+
+static bool itu_sys_collisions_manifold_circle_circle(CollisionsShape* a, CollisionsShape* b, vec2f* out_normal, float* out_depth)
+{
+	if(!itu_lib_overlaps_circle_circle(a->center, a->radius, b->center, b->radius))
+		return false;
+
+	vec2f v = b->center - a->center;
+	float l = length(v);
+
+	// NOTE: perfectly concentric circles have no meaningful normal, we just pick one
+	*out_normal = l > 0 ? v / l : VEC2F_UP;
+	*out_depth = a->radius + b->radius - l;
+	return true;
+}
+
+static bool itu_sys_collisions_manifold_rect_rect(CollisionsShape* a, CollisionsShape* b, vec2f* out_normal, float* out_depth)
+{
+	vec2f min_a = a->center - a->half_size;
+	vec2f max_a = a->center + a->half_size;
+	vec2f min_b = b->center - b->half_size;
+	vec2f max_b = b->center + b->half_size;
+	if(!itu_lib_overlaps_rect_rect(min_a, max_a, min_b, max_b))
+		return false;
+
+	// separate along the axis with the smallest overlap
+	float overlap_x = SDL_min(max_a.x, max_b.x) - SDL_max(min_a.x, min_b.x);
+	float overlap_y = SDL_min(max_a.y, max_b.y) - SDL_max(min_a.y, min_b.y);
+	vec2f v = b->center - a->center;
+	if(overlap_x < overlap_y)
+	{
+		*out_normal = v.x < 0 ? VEC2F_LEFT : VEC2F_RIGHT;
+		*out_depth = overlap_x;
+	}
+	else
+	{
+		*out_normal = v.y < 0 ? VEC2F_DOWN : VEC2F_UP;
+		*out_depth = overlap_y;
+	}
+	return true;
+}
+
+static bool itu_sys_collisions_manifold_circle_rect(CollisionsShape* circle, CollisionsShape* rect, vec2f* out_normal, float* out_depth)
+{
+	vec2f rect_min = rect->center - rect->half_size;
+	vec2f rect_max = rect->center + rect->half_size;
+
+	vec2f closest = vec2f{
+		SDL_clamp(circle->center.x, rect_min.x, rect_max.x),
+		SDL_clamp(circle->center.y, rect_min.y, rect_max.y)
+	};
+
+	vec2f v = closest - circle->center;
+	float l_sq = length_sq(v);
+	if(l_sq > 0)
+	{
+		// center outside the rect: push along the direction to the closest point
+		if(l_sq >= circle->radius * circle->radius)
+			return false;
+
+		float l = SDL_sqrtf(l_sq);
+		*out_normal = v / l;
+		*out_depth = circle->radius - l;
+		return true;
+	}
+
+	// center inside the rect: push out through the closest edge
+	float dist_left   = circle->center.x - rect_min.x;
+	float dist_right  = rect_max.x - circle->center.x;
+	float dist_bottom = circle->center.y - rect_min.y;
+	float dist_top    = rect_max.y - circle->center.y;
+	float dist_min = SDL_min(SDL_min(dist_left, dist_right), SDL_min(dist_bottom, dist_top));
+
+	// NOTE: the normal goes from the circle to the rect, so it's opposite to the edge we exit from
+	if(dist_min == dist_left)
+		*out_normal = VEC2F_RIGHT;
+	else if(dist_min == dist_right)
+		*out_normal = VEC2F_LEFT;
+	else if(dist_min == dist_bottom)
+		*out_normal = VEC2F_UP;
+	else
+		*out_normal = VEC2F_DOWN;
+	*out_depth = dist_min + circle->radius;
+	return true;
+}
+
+// projects a convex shape (vertices inflated by `radius`) on `axis`
+static void itu_sys_collisions_sat_project(vec2f* vertices, int vertices_count, float radius, vec2f axis, float* out_min, float* out_max)
+{
+	float min = dot(vertices[0], axis);
+	float max = min;
+	for(int i = 1; i < vertices_count; ++i)
+	{
+		float d = dot(vertices[i], axis);
+		min = SDL_min(min, d);
+		max = SDL_max(max, d);
+	}
+	*out_min = min - radius;
+	*out_max = max + radius;
+}
+
+// tests a single separating axis. Returns false if the shapes are separated on it, otherwise keeps the axis if it's the
+// one with the smallest overlap so far
+static bool itu_sys_collisions_sat_axis(vec2f axis, vec2f* vertices_a, int count_a, float radius_a, vec2f* vertices_b, int count_b, float radius_b, vec2f* out_normal, float* out_depth)
+{
+	float min_a, max_a, min_b, max_b;
+	itu_sys_collisions_sat_project(vertices_a, count_a, radius_a, axis, &min_a, &max_a);
+	itu_sys_collisions_sat_project(vertices_b, count_b, radius_b, axis, &min_b, &max_b);
+
+	// overlap when pushing `b` forward along the axis, and when pushing it backward
+	float overlap_forward  = max_a - min_b;
+	float overlap_backward = max_b - min_a;
+	if(overlap_forward <= 0 || overlap_backward <= 0)
+		return false;
+
+	float overlap = SDL_min(overlap_forward, overlap_backward);
+	if(overlap < *out_depth)
+	{
+		*out_depth = overlap;
+		*out_normal = overlap_forward < overlap_backward ? axis : -axis;
+	}
+	return true;
+}
+
+// the edge normals of a polygon are all its candidate separating axes
+// (winding order doesn't matter, `itu_sys_collisions_sat_axis()` tests both directions)
+static bool itu_sys_collisions_sat_edges(vec2f* vertices_poly, int count_poly, vec2f* vertices_a, int count_a, float radius_a, vec2f* vertices_b, int count_b, float radius_b, vec2f* out_normal, float* out_depth)
+{
+	for(int i = 0; i < count_poly; ++i)
+	{
+		vec2f edge = vertices_poly[(i + 1) % count_poly] - vertices_poly[i];
+		float l = length(edge);
+		if(l == 0)
+			continue;
+		vec2f axis = vec2f{ edge.y, -edge.x } / l;
+		if(!itu_sys_collisions_sat_axis(axis, vertices_a, count_a, radius_a, vertices_b, count_b, radius_b, out_normal, out_depth))
+			return false;
+	}
+	return true;
+}
+
+// circles only need one more axis: the one towards the closest vertex of the other shape
+static bool itu_sys_collisions_sat_circle(vec2f circle_center, vec2f* vertices_poly, int count_poly, vec2f* vertices_a, int count_a, float radius_a, vec2f* vertices_b, int count_b, float radius_b, vec2f* out_normal, float* out_depth)
+{
+	vec2f closest = vertices_poly[0];
+	float closest_dist_sq = distance_sq(circle_center, closest);
+	for(int i = 1; i < count_poly; ++i)
+	{
+		float d = distance_sq(circle_center, vertices_poly[i]);
+		if(d < closest_dist_sq)
+		{
+			closest_dist_sq = d;
+			closest = vertices_poly[i];
+		}
+	}
+	if(closest_dist_sq == 0)
+		return true;
+
+	vec2f axis = (closest - circle_center) / SDL_sqrtf(closest_dist_sq);
+	return itu_sys_collisions_sat_axis(axis, vertices_a, count_a, radius_a, vertices_b, count_b, radius_b, out_normal, out_depth);
+}
+
+// rects are treated as 4-vertex polygons, circles as 1-vertex polygons with a radius
+static void itu_sys_collisions_sat_vertices(CollisionsShape* shape, vec2f* tmp_vertices, vec2f** out_vertices, int* out_count, float* out_radius)
+{
+	switch(shape->type)
+	{
+		case COLLIDER_CIRCLE:
+		{
+			tmp_vertices[0] = shape->center;
+			*out_vertices = tmp_vertices;
+			*out_count = 1;
+			*out_radius = shape->radius;
+			break;
+		}
+		case COLLIDER_RECT:
+		{
+			vec2f min = shape->center - shape->half_size;
+			vec2f max = shape->center + shape->half_size;
+			tmp_vertices[0] = vec2f{ min.x, min.y };
+			tmp_vertices[1] = vec2f{ max.x, min.y };
+			tmp_vertices[2] = vec2f{ max.x, max.y };
+			tmp_vertices[3] = vec2f{ min.x, max.y };
+			*out_vertices = tmp_vertices;
+			*out_count = 4;
+			*out_radius = 0;
+			break;
+		}
+		case COLLIDER_POLYGON:
+		{
+			*out_vertices = shape->vertices;
+			*out_count = shape->vertices_count;
+			*out_radius = 0;
+			break;
+		}
+	}
+}
+
+// separating axis theorem, for everything involving a polygon
+static bool itu_sys_collisions_manifold_sat(CollisionsShape* a, CollisionsShape* b, vec2f* out_normal, float* out_depth)
+{
+	vec2f tmp_a[4];
+	vec2f tmp_b[4];
+	vec2f* vertices_a;
+	vec2f* vertices_b;
+	int count_a, count_b;
+	float radius_a, radius_b;
+	itu_sys_collisions_sat_vertices(a, tmp_a, &vertices_a, &count_a, &radius_a);
+	itu_sys_collisions_sat_vertices(b, tmp_b, &vertices_b, &count_b, &radius_b);
+	if(count_a == 0 || count_b == 0)
+		return false;
+
+	*out_depth = FLOAT_MAX_VAL;
+	if(a->type == COLLIDER_CIRCLE)
+	{
+		if(!itu_sys_collisions_sat_circle(a->center, vertices_b, count_b, vertices_a, count_a, radius_a, vertices_b, count_b, radius_b, out_normal, out_depth))
+			return false;
+	}
+	else if(!itu_sys_collisions_sat_edges(vertices_a, count_a, vertices_a, count_a, radius_a, vertices_b, count_b, radius_b, out_normal, out_depth))
+		return false;
+
+	if(b->type == COLLIDER_CIRCLE)
+	{
+		if(!itu_sys_collisions_sat_circle(b->center, vertices_a, count_a, vertices_a, count_a, radius_a, vertices_b, count_b, radius_b, out_normal, out_depth))
+			return false;
+	}
+	else if(!itu_sys_collisions_sat_edges(vertices_b, count_b, vertices_a, count_a, radius_a, vertices_b, count_b, radius_b, out_normal, out_depth))
+		return false;
+
+	return true;
+}
+
+static bool itu_sys_collisions_manifold(CollisionsShape* a, CollisionsShape* b, vec2f* out_normal, float* out_depth)
+{
+	if(a->type == COLLIDER_CIRCLE && b->type == COLLIDER_CIRCLE)
+		return itu_sys_collisions_manifold_circle_circle(a, b, out_normal, out_depth);
+	if(a->type == COLLIDER_RECT && b->type == COLLIDER_RECT)
+		return itu_sys_collisions_manifold_rect_rect(a, b, out_normal, out_depth);
+	if(a->type == COLLIDER_CIRCLE && b->type == COLLIDER_RECT)
+		return itu_sys_collisions_manifold_circle_rect(a, b, out_normal, out_depth);
+	if(a->type == COLLIDER_RECT && b->type == COLLIDER_CIRCLE)
+	{
+		bool ret = itu_sys_collisions_manifold_circle_rect(b, a, out_normal, out_depth);
+		*out_normal = -*out_normal;
+		return ret;
+	}
+	return itu_sys_collisions_manifold_sat(a, b, out_normal, out_depth);
+}
+
+// ********************************************************************************************************************
+// system
+// ********************************************************************************************************************
+
+static inline Uint32 itu_sys_collisions_cell_hash(int cell_x, int cell_y, Uint32 buckets_mask)
+{
+	return ((Uint32)cell_x * 73856093u ^ (Uint32)cell_y * 19349663u) & buckets_mask;
+}
+
+void itu_system_collisions(SDLContext* context, ITU_EntityId* entity_ids, int entity_ids_count)
+{
+	Uint64 time_start = SDL_GetTicksNS();
+
+	stbds_arrsetlen(sys_collisions_data.pairs, 0);
+	stbds_arrsetlen(sys_collisions_data.contacts, 0);
+	stbds_arrsetlen(sys_collisions_data.entities, entity_ids_count);
+	SDL_memcpy(sys_collisions_data.entities, entity_ids, entity_ids_count * sizeof(ITU_EntityId));
+
+	SDL_zero(sys_collisions_data.stats);
+	sys_collisions_data.stats.colliders_count = entity_ids_count;
+	if(entity_ids_count == 0)
+		return;
+
+	ITU_Arena* arena = itu_lib_arena_frame();
+	Collider**       colliders  = arena_push_array(arena, Collider*, entity_ids_count);
+	CollisionsShape* shapes     = arena_push_array(arena, CollisionsShape, entity_ids_count);
+	vec2f*           aabbs_min  = arena_push_array(arena, vec2f, entity_ids_count);
+	vec2f*           aabbs_max  = arena_push_array(arena, vec2f, entity_ids_count);
+	int*             cells_span = arena_push_array(arena, int, entity_ids_count * 4); // min x, min y, max x, max y
+	vec2f*           displacements = arena_push_array(arena, vec2f, entity_ids_count);
+	if(!colliders || !shapes || !aabbs_min || !aabbs_max || !cells_span || !displacements)
+	{
+		SDL_Log("WARNING out of frame memory, collisions skipped this frame\n");
+		return;
+	}
+
+	// world shapes
+	int polygon_vertices_count = 0;
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		colliders[i] = entity_get_data(entity_ids[i], Collider);
+		if(colliders[i]->type == COLLIDER_POLYGON)
+			polygon_vertices_count += colliders[i]->polygon.vertices_count;
+	}
+	vec2f* polygon_vertices = arena_push_array(arena, vec2f, polygon_vertices_count);
+	if(polygon_vertices_count > 0 && !polygon_vertices)
+	{
+		SDL_Log("WARNING out of frame memory, collisions skipped this frame\n");
+		return;
+	}
+
+	float cell_size_inv = 1.0f / sys_collisions_data.cell_size;
+	int cells_entries_count = 0;
+	int polygon_vertices_next = 0;
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		Transform* transform = entity_get_data(entity_ids[i], Transform);
+		itu_sys_collisions_shape_make(colliders[i], transform, polygon_vertices + polygon_vertices_next, &shapes[i], &aabbs_min[i], &aabbs_max[i]);
+		polygon_vertices_next += shapes[i].vertices_count;
+
+		int* span = cells_span + i * 4;
+		span[0] = (int)SDL_floorf(aabbs_min[i].x * cell_size_inv);
+		span[1] = (int)SDL_floorf(aabbs_min[i].y * cell_size_inv);
+		span[2] = (int)SDL_floorf(aabbs_max[i].x * cell_size_inv);
+		span[3] = (int)SDL_floorf(aabbs_max[i].y * cell_size_inv);
+		cells_entries_count += (span[2] - span[0] + 1) * (span[3] - span[1] + 1);
+
+		displacements[i] = VEC2F_ZERO;
+	}
+	sys_collisions_data.stats.cells_entries_count = cells_entries_count;
+
+	// broadphase grid: hashed cells, laid out contiguously with a counting sort
+	// (`buckets_start[b]` is the first entry of bucket `b`, and the entries of bucket `b` end where `b+1` starts)
+	Uint32 buckets_count = 64;
+	while(buckets_count < (Uint32)cells_entries_count * 2)
+		buckets_count <<= 1;
+	Uint32 buckets_mask = buckets_count - 1;
+
+	int* buckets_start = arena_push_array(arena, int, buckets_count + 1);
+	CollisionsCellEntry* entries = arena_push_array(arena, CollisionsCellEntry, cells_entries_count);
+	if(!buckets_start || !entries)
+	{
+		SDL_Log("WARNING out of frame memory, collisions skipped this frame\n");
+		return;
+	}
+	SDL_memset(buckets_start, 0, (buckets_count + 1) * sizeof(int));
+
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		int* span = cells_span + i * 4;
+		for(int y = span[1]; y <= span[3]; ++y)
+			for(int x = span[0]; x <= span[2]; ++x)
+				buckets_start[itu_sys_collisions_cell_hash(x, y, buckets_mask) + 1]++;
+	}
+	for(Uint32 b = 0; b < buckets_count; ++b)
+		buckets_start[b + 1] += buckets_start[b];
+
+	// NOTE: filling moves the start of every bucket to its end (which is the start of the next one),
+	//       so we shift everything back by one afterwards
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		int* span = cells_span + i * 4;
+		for(int y = span[1]; y <= span[3]; ++y)
+			for(int x = span[0]; x <= span[2]; ++x)
+			{
+				Uint32 b = itu_sys_collisions_cell_hash(x, y, buckets_mask);
+				entries[buckets_start[b]++] = { aabbs_min[i], aabbs_max[i], i, x, y, colliders[i]->is_static };
+			}
+	}
+	for(Uint32 b = buckets_count; b > 0; --b)
+		buckets_start[b] = buckets_start[b - 1];
+	buckets_start[0] = 0;
+
+	// candidate pairs
+	int pairs_tested_count = 0;
+	for(Uint32 b = 0; b < buckets_count; ++b)
+	{
+		int start = buckets_start[b];
+		int end = buckets_start[b + 1];
+		for(int j = start; j < end - 1; ++j)
+		{
+			CollisionsCellEntry* entry_j = &entries[j];
+			for(int k = j + 1; k < end; ++k)
+			{
+				CollisionsCellEntry* entry_k = &entries[k];
+				if(!itu_lib_overlaps_rect_rect(entry_j->aabb_min, entry_j->aabb_max, entry_k->aabb_min, entry_k->aabb_max))
+					continue;
+
+				if(entry_j->cell_x != entry_k->cell_x || entry_j->cell_y != entry_k->cell_y || entry_j->collider == entry_k->collider)
+					continue;
+
+				if(entry_j->is_static && entry_k->is_static)
+					continue;
+
+				// pairs sharing more than one cell are only tested in the cell containing the min corner of the AABBs intersection
+				int owner_x = (int)SDL_floorf(SDL_max(entry_j->aabb_min.x, entry_k->aabb_min.x) * cell_size_inv);
+				int owner_y = (int)SDL_floorf(SDL_max(entry_j->aabb_min.y, entry_k->aabb_min.y) * cell_size_inv);
+				if(owner_x != entry_j->cell_x || owner_y != entry_j->cell_y)
+					continue;
+
+				++pairs_tested_count;
+
+				// keep `a` as the lowest index, so that results don't depend on the layout of the grid
+				int a = entry_j->collider;
+				int c = entry_k->collider;
+				if(a > c)
+				{
+					int tmp = a;
+					a = c;
+					c = tmp;
+				}
+
+				CollisionContact contact;
+				if(!itu_sys_collisions_manifold(&shapes[a], &shapes[c], &contact.normal, &contact.depth))
+					continue;
+				contact.a = entity_ids[a];
+				contact.b = entity_ids[c];
+				contact.is_sensor = colliders[a]->is_sensor || colliders[c]->is_sensor;
+				stbds_arrput(sys_collisions_data.contacts, contact);
+
+				if(contact.is_sensor)
+					continue;
+
+				CollisionsPair pair;
+				pair.a = a;
+				pair.b = c;
+				pair.normal = contact.normal;
+				pair.depth = contact.depth;
+				pair.share_a = colliders[a]->is_static ? 0.0f : colliders[c]->is_static ? 1.0f : 0.5f;
+				pair.share_b = 1.0f - pair.share_a;
+				stbds_arrput(sys_collisions_data.pairs, pair);
+			}
+		}
+	}
+
+	// separation
+	// NOTE: depths are not recomputed from the shapes between iterations, we just remove what the previous
+	//       iterations already pushed along the normal. It's a good approximation as long as the correction is small
+	int pairs_count = (int)stbds_arrlen(sys_collisions_data.pairs);
+	for(int iter = 0; iter < COLLISIONS_ITERATIONS; ++iter)
+	{
+		for(int i = 0; i < pairs_count; ++i)
+		{
+			CollisionsPair* pair = &sys_collisions_data.pairs[i];
+			float depth = pair->depth - dot(displacements[pair->b] - displacements[pair->a], pair->normal);
+			if(depth <= 0)
+				continue;
+
+			vec2f correction = pair->normal * depth;
+			displacements[pair->a] -= correction * pair->share_a;
+			displacements[pair->b] += correction * pair->share_b;
+		}
+	}
+
+	for(int i = 0; i < entity_ids_count; ++i)
+	{
+		if(displacements[i].x == 0 && displacements[i].y == 0)
+			continue;
+		Transform* transform = entity_get_data(entity_ids[i], Transform);
+		transform->position += displacements[i];
+	}
+
+	sys_collisions_data.stats.pairs_tested_count = pairs_tested_count;
+	sys_collisions_data.stats.contacts_count = (int)stbds_arrlen(sys_collisions_data.contacts);
+	sys_collisions_data.stats.update_ms = (float)(SDL_GetTicksNS() - time_start) / MILLIS(1);
+}
+
+// draws all colliders of the last run of the system, in their current position
+void itu_sys_collisions_debug_draw(SDLContext* context)
+{
+	itu_lib_render_debug_begin();
+	int count = (int)stbds_arrlen(sys_collisions_data.entities);
+	for(int i = 0; i < count; ++i)
+	{
+		ITU_EntityId id = sys_collisions_data.entities[i];
+		if(!itu_entity_is_valid(id))
+			continue;
+
+		Collider* collider = entity_get_data(id, Collider);
+		Transform* transform = entity_get_data(id, Transform);
+		if(!collider || !transform)
+			continue;
+
+		vec2f vertices[COLLIDER_POLYGON_VERTICES_MAX];
+		CollisionsShape shape;
+		vec2f aabb_min, aabb_max;
+		itu_sys_collisions_shape_make(collider, transform, vertices, &shape, &aabb_min, &aabb_max);
+
+		color c = collider->is_sensor ? COLOR_YELLOW : collider->is_static ? COLOR_WHITE : COLOR_GREEN;
+		switch(shape.type)
+		{
+			case COLLIDER_CIRCLE:  itu_lib_render_draw_world_circle(context, shape.center, shape.radius, 16, c); break;
+			case COLLIDER_RECT:    itu_lib_render_draw_world_rect(context, aabb_min, aabb_max, c); break;
+			case COLLIDER_POLYGON:
+			{
+				for(int j = 0; j < shape.vertices_count; ++j)
+					itu_lib_render_draw_world_line(context, shape.vertices[j], shape.vertices[(j + 1) % shape.vertices_count], c);
+				break;
+			}
+		}
+	}
+
+	int contacts_count = (int)stbds_arrlen(sys_collisions_data.contacts);
+	for(int i = 0; i < contacts_count; ++i)
+	{
+		CollisionContact* contact = &sys_collisions_data.contacts[i];
+		if(!itu_entity_is_valid(contact->a))
+			continue;
+		Transform* transform = entity_get_data(contact->a, Transform);
+		itu_lib_render_draw_world_line(context, transform->position, transform->position + contact->normal * 0.5f, COLOR_RED);
+	}
+	itu_lib_render_debug_end(context->renderer);
+}
+
+#endif // (defined ITU_SYS_COLLISIONS_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
@@ -8,20 +8,58 @@
 #include <itu_lib_engine.hpp>
 #endif
 
+// number of threads used to step the world (including the main thread)
+// 0 means one for each logical core (up to PHYSICS_WORKERS_MAX), 1 means single threaded
+#ifndef PHYSICS_WORKERS_COUNT
+#define PHYSICS_WORKERS_COUNT 0
+#endif
+#define PHYSICS_WORKERS_MAX 16
+
+// max number of box2d tasks queued at the same time. When full, the queue is flushed (waiting for all queued tasks
+// to complete) before accepting new ones
+#ifndef PHYSICS_TASKS_MAX
+#define PHYSICS_TASKS_MAX 128
+#endif
+
+// batched queries are split in chunks of (at least) this many queries between workers
+#define PHYSICS_QUERIES_MIN_RANGE 16
+
+// time per frame we are willing to spend stepping physics (see `itu_sys_physics_budget_get_steps_allowed()`)
+#ifndef PHYSICS_BUDGET_NSECS
+#define PHYSICS_BUDGET_NSECS MILLIS(8)
+#endif
+
+// quality tiers: box2d substeps are lowered (down to MIN) while overloaded, and raised back (up to MAX) when there's room
+#define PHYSICS_SUBSTEPS_MAX 4
+#define PHYSICS_SUBSTEPS_MIN 1
+
+// size of the `Contacts` ring buffer (older contacts of the same frame are overwritten)
+#ifndef PHYSICS_MAX_CONTACTS_PER_ENTITY
+#define PHYSICS_MAX_CONTACTS_PER_ENTITY 16
+#endif
+
+// max number of entities with a `Contacts` component
+#ifndef PHYSICS_CONTACTS_COMPONENTS_MAX
+#define PHYSICS_CONTACTS_COMPONENTS_MAX 1024
+#endif
 
 
 struct PhysicsData
 {
 	b2BodyId body_id;
 
-	vec2f fixed_step_position;
-	float fixed_step_rotation;
-	vec2f fixed_step_velocity;
-	float fixed_step_torque;
-
 	vec2f velocity;
 	float torque;
 
+	// last values written by the physics system, so that velocities are pushed to box2d only when game logic changes them
+	vec2f synced_velocity;
+	float synced_torque;
+
+	// latency-sensitive entities (ie, the player) can be pushed ahead along their velocity instead of
+	// being interpolated between the last two steps (which always lags up to one step behind)
+	// NOTE: extrapolated entities can briefly overshoot collisions
+	bool extrapolate;
+
 	bool ignore_position;
 	bool ignore_rotation;
 };
@@ -31,18 +69,177 @@ struct PhysicsStaticData
 	b2BodyId body_id;
 };
 
+enum PhysicsContactType
+{
+	PHYSICS_CONTACT_BEGIN,
+	PHYSICS_CONTACT_END,
+	PHYSICS_CONTACT_HIT,
+	PHYSICS_SENSOR_BEGIN, // `shape` is the sensor
+	PHYSICS_SENSOR_END,
+	PHYSICS_VISIT_BEGIN,  // `shape` is visiting a sensor of `other`
+	PHYSICS_VISIT_END,
+};
+
+struct PhysicsContact
+{
+	ITU_EntityId other;   // ITU_ENTITY_ID_NULL if its shape was destroyed (end events only)
+	b2ShapeId shape;      // shape of this entity
+	vec2f normal;         // points from this entity towards `other` (contact begin and hit only)
+	vec2f point;          // world space (contact begin and hit only)
+	float approach_speed; // hit only
+	PhysicsContactType type;
+};
+
+// contact and sensor events of all the steps run this frame, translated by the physics system
+// NOTE: only use `itu_sys_physics_contacts_count()`/`itu_sys_physics_contacts_get()` to read them, the buffer is
+//       cleared lazily (ie, the first time something is written in a new frame)
+struct Contacts
+{
+	PhysicsContact items[PHYSICS_MAX_CONTACTS_PER_ENTITY];
+	int head;     // next write
+	int count;    // written this frame (can be more than PHYSICS_MAX_CONTACTS_PER_ENTITY)
+	Uint32 frame;
+};
+
 struct ShapeData
 {
 	b2ShapeId shape_id;
 };
 
+// shape geometry wrapper, so that shapes of different types can be stored and created the same way (ie, by prefabs)
+struct ITU_PhysicsShape
+{
+	b2ShapeType type;
+	union
+	{
+		b2Circle  circle;
+		b2Capsule capsule;
+		b2Polygon polygon;
+	};
+};
+
 void itu_sys_physics_init(SDLContext* context);
 void itu_sys_physics_reset(const b2WorldDef* world_def);
 void itu_sys_physics_step(float fixed_delta);
-b2BodyId itu_sys_physics_add_body(void* entity, b2BodyDef* body_def);
+
+// budget controller
+// step cost is measured every step, and used to decide how many steps fit in the frame budget.
+// Simulation time that doesn't fit is dropped (ie, the game slows down instead of falling in a spiral of death),
+// and if it keeps happening box2d substeps are lowered
+struct PhysicsBudgetStats
+{
+	float    step_cost_ms;     // moving average
+	int      substeps_count;   // current quality tier
+	int      steps_allowed;    // this frame
+	SDL_Time dropped_frame;    // simulation time dropped this frame (ns)
+	SDL_Time dropped_total;    // simulation time dropped since last reset (ns)
+};
+void itu_sys_physics_set_budget(SDL_Time budget_ns);
+int  itu_sys_physics_budget_get_steps_allowed(int steps_max);
+void itu_sys_physics_budget_frame_end(SDL_Time dropped_ns);
+PhysicsBudgetStats itu_sys_physics_get_budget_stats();
+
+void itu_sys_physics_set_workers_count(int count);
+int  itu_sys_physics_get_workers_count();
+b2Profile itu_sys_physics_get_profile();
+b2BodyId itu_sys_physics_add_body(ITU_EntityId entity, b2BodyDef* body_def);
+b2BodyId itu_sys_physics_add_body_untyped(void* user_data, b2BodyDef* body_def);
+b2ShapeId itu_sys_physics_add_shape(b2BodyId body_id, b2ShapeDef* shape_def, ITU_PhysicsShape* shape);
+void itu_sys_physics_add_bodies(ITU_EntityId* entities, int count, b2BodyDef* body_def, b2ShapeDef* shape_def, ITU_PhysicsShape* shape, vec2f* positions, b2BodyId* out_body_ids, b2ShapeId* out_shape_ids);
+
+// body pools
+// for high-churn entities (ie, projectiles) creating and destroying bodies every time is expensive (box2d allocators,
+// broadphase proxies, ...). A pool pre-creates disabled bodies (with a single shape) from the same definitions, so that
+// acquiring one is just moving and enabling it, and releasing it is disabling it again.
+// Pools are identified by the index returned from `itu_sys_physics_body_pool_create()`
+// NOTE: pools belong to the current world, `itu_sys_physics_reset()` destroys them all
+int      itu_sys_physics_body_pool_create(b2BodyDef* body_def, b2ShapeDef* shape_def, ITU_PhysicsShape* shape, int capacity);
+b2BodyId itu_sys_physics_body_pool_acquire(int pool_idx, ITU_EntityId entity, vec2f position, float angle);
+void     itu_sys_physics_body_pool_release(int pool_idx, b2BodyId body_id);
+int      itu_sys_physics_body_pool_get_acquired_count(int pool_idx);
+
+// snapshots
+// state of all bodies created through the wrapper (transform, velocities, awake/enabled), packed in a single
+// allocation from the given arena, so that keeping a history (ie, for rollback or replays) is cheap.
+// Restoring writes it back into the same world (bodies created after the snapshot are left untouched)
+// NOTE: box2d doesn't expose its contact cache (warm starting impulses, contact ordering, islands), so it can't be
+//       captured. Restoring is exact only if the world didn't step since the snapshot was taken; after rewinding,
+//       continuation is close but NOT bit-identical (a 200 box stack drifts less than 0.1 units over 120 steps, 0.01
+//       with warm starting disabled through `b2World_EnableWarmStarting()`). See tests/T01_physics_snapshot_restore.cpp
+struct PhysicsSnapshot
+{
+	int bodies_count;
+	int substeps_count;
+
+	b2BodyId*    body_ids;
+	b2Transform* transforms;
+	b2Vec2*      velocities;
+	float*       angular_velocities;
+	Uint8*       flags;
+};
+PhysicsSnapshot* itu_sys_physics_snapshot_save(ITU_Arena* arena);
+void             itu_sys_physics_snapshot_restore(PhysicsSnapshot* snapshot);
+
+// body <-> entity mapping
+// the entity id is packed in the user data of bodies and shapes created by the wrapper, so getting it back
+// from events, contacts and queries is just a read (no lookup).
+// The index is stored off by one, so that bodies without user data map to `ITU_ENTITY_ID_NULL` instead of entity 0
+static_assert(sizeof(ITU_EntityId) <= sizeof(void*), "ITU_EntityId must fit in box2d user data");
+ITU_EntityId itu_sys_physics_body_get_entity(b2BodyId body_id);
+ITU_EntityId itu_sys_physics_shape_get_entity(b2ShapeId shape_id);
 void* itu_sys_physics_get_entity(b2BodyId body_id);
 b2SensorEvents ity_sys_physics_get_sensor_events();
+b2BodyEvents itu_sys_physics_get_body_events();
+
+// batched spatial queries
+// every query of a batch is run on the physics workers (read-only, so never during a step), and results are
+// written in the frame arena, one element for each query (valid until the end of next frame, NULL if out of memory).
+// Shapes are mapped back to their entity directly, through their user data
+struct PhysicsQueryAABB      { vec2f min; vec2f max; };
+struct PhysicsQueryCircle    { vec2f center; float radius; };
+struct PhysicsQueryRay       { vec2f origin; vec2f translation; };
+struct PhysicsQueryShapeCast { ITU_PhysicsShape shape; vec2f position; float angle; vec2f translation; };
+
+// all entities found by an overlap query (at most `results_max`, each entity only once even if more of its shapes overlap)
+struct PhysicsQueryOverlaps
+{
+	ITU_EntityId* ids;
+	int count;
+};
+
+// closest hit of a cast query
+struct PhysicsQueryHit
+{
+	ITU_EntityId entity;
+	vec2f point;
+	vec2f normal;
+	float fraction;
+	bool hit;
+};
+
+PhysicsQueryOverlaps* itu_sys_physics_query_aabb      (PhysicsQueryAABB*      queries, int count, b2QueryFilter filter, int results_max);
+PhysicsQueryOverlaps* itu_sys_physics_query_circle    (PhysicsQueryCircle*    queries, int count, b2QueryFilter filter, int results_max);
+PhysicsQueryHit*      itu_sys_physics_query_ray       (PhysicsQueryRay*       queries, int count, b2QueryFilter filter);
+PhysicsQueryHit*      itu_sys_physics_query_shape_cast(PhysicsQueryShapeCast* queries, int count, b2QueryFilter filter);
+
+// render interpolation
+// the poses of the last two steps of every moving body are kept in a SoA buffer (indexed by entity index), filled from
+// box2d move events after each step. Every frame (even the ones without steps) all bodies that haven't settled yet
+// are blended with the leftover accumulator fraction
+void itu_sys_physics_poses_frame_begin();
+void itu_sys_physics_poses_read_step();
+int  itu_sys_physics_poses_get_active(ITU_EntityId** out_ids);
+void itu_sys_physics_poses_blend(ITU_EntityId id, float alpha, vec2f* out_position, float* out_angle);
+void itu_sys_physics_poses_extrapolate(ITU_EntityId id, float dt, vec2f velocity, float angular_velocity, vec2f* out_position, float* out_angle);
+
+// per-entity contacts
+// events of the last step are translated into the `Contacts` component of both entities involved
+void itu_sys_physics_contacts_read_step();
+int  itu_sys_physics_contacts_count(Contacts* contacts);
+PhysicsContact* itu_sys_physics_contacts_get(Contacts* contacts, int i);
+
 void itu_sys_physics_debug_draw();
+b2DebugDraw* itu_sys_physics_get_debug_draw();
 
 
 #endif // ITU_SYS_PHYSICS_HPP
@@ -55,54 +252,744 @@ void itu_sys_physics_debug_draw();
 
 #include <box2d/box2d.h>
 
+// a box2d task, split in chunks that are picked up by whichever worker is free
+// NOTE: all fields are protected by the pool mutex
+struct PhysicsTask
+{
+	b2TaskCallback* fn_task;
+	void* task_context;
+	int item_count;
+	int chunk_size;
+	int chunks_count;
+	int chunks_next;
+	int chunks_done;
+};
+
+// persistent worker threads, fed by box2d through `enqueueTask`/`finishTask`
+// worker 0 is the main thread, which helps with the task it is waiting on in `finishTask`
+struct PhysicsWorkerPool
+{
+	int workers_count; // including main thread
+	SDL_Thread* threads[PHYSICS_WORKERS_MAX];
+
+	SDL_Mutex*     mutex;
+	SDL_Condition* cond_work;  // signaled when new tasks are available (or when quitting)
+	SDL_Condition* cond_done;  // signaled when a task is completed
+
+	PhysicsTask tasks[PHYSICS_TASKS_MAX];
+	int tasks_count;   // reset at every step (all tasks are finished by the time `b2World_Step()` returns)
+	int tasks_flushed; // tasks enqueued during this step that were already flushed out of `tasks`
+	bool quit;
+};
+
+// fixed-step poses, one slot for each possible entity index
+struct PhysicsPoses
+{
+	Uint32* slot_generation; // generation + 1 of the entity that owns the slot (0 for unused slots)
+	Uint32* moved_frame;       // last frame the slot got a new pose
+	Uint32* active_generation; // generation + 1 of the entity of this slot that is in `active` (0 if none)
+	float* prev_x;
+	float* prev_y;
+	float* prev_angle;
+	float* curr_x;
+	float* curr_y;
+	float* curr_angle;
+
+	stbds_arr(ITU_EntityId) active; // entities whose poses still need blending (kept across frames until they settle)
+	Uint32 frame;
+};
+
+struct PhysicsBudget
+{
+	SDL_Time budget;
+	float step_cost_avg;    // ns
+	int steps_max;          // as passed to the last `itu_sys_physics_budget_get_steps_allowed()`
+	int frames_overloaded;  // consecutive
+	int frames_relaxed;     // consecutive
+	Uint64 last_warning_ticks;
+
+	PhysicsBudgetStats stats;
+};
+
+struct PhysicsBodyPool
+{
+	b2BodyDef body_def;
+	b2ShapeDef shape_def;
+	ITU_PhysicsShape shape;
+
+	stbds_arr(b2BodyId) bodies_free; // disabled, ready to be acquired
+	int bodies_count;
+	bool warned_exhausted;
+};
+
 struct SysPhysics
 {
 	b2WorldId world_id;
 	b2DebugDraw debug_draw;
-	stbds_hm(b2BodyId, void*) map_b2body_entity;
+
+	stbds_arr(PhysicsBodyPool) body_pools;
+	stbds_arr(b2BodyId) bodies; // all bodies created through the wrapper (destroyed ones are removed lazily)
+
+	int workers_count_requested;
+	PhysicsWorkerPool pool;
+
+	PhysicsPoses poses;
+	PhysicsBudget budget;
 };
 
 SysPhysics sys_physics_data;
 
+// picks a chunk from the first task that still has some
+// NOTE: must be called with the pool mutex locked
+static PhysicsTask* itu_sys_physics_pool_take_chunk(PhysicsWorkerPool* pool, PhysicsTask* task_only, int* out_chunk)
+{
+	for(int i = 0; i < pool->tasks_count; ++i)
+	{
+		PhysicsTask* task = &pool->tasks[i];
+		if(task_only && task != task_only)
+			continue;
+		if(task->chunks_next < task->chunks_count)
+		{
+			*out_chunk = task->chunks_next++;
+			return task;
+		}
+	}
+	return NULL;
+}
+
+// runs the chunk with the mutex unlocked
+// NOTE: must be called with the pool mutex locked
+static void itu_sys_physics_pool_run_chunk(PhysicsWorkerPool* pool, PhysicsTask* task, int chunk, int worker_index)
+{
+	int start = chunk * task->chunk_size;
+	int end   = SDL_min(start + task->chunk_size, task->item_count);
+
+	SDL_UnlockMutex(pool->mutex);
+	task->fn_task(start, end, worker_index, task->task_context);
+	SDL_LockMutex(pool->mutex);
+
+	task->chunks_done++;
+	if(task->chunks_done == task->chunks_count)
+		SDL_BroadcastCondition(pool->cond_done);
+}
+
+static int itu_sys_physics_pool_worker(void* data)
+{
+	PhysicsWorkerPool* pool = &sys_physics_data.pool;
+	int worker_index = (int)(intptr_t)data;
+
+	SDL_LockMutex(pool->mutex);
+	while(!pool->quit)
+	{
+		int chunk;
+		PhysicsTask* task = itu_sys_physics_pool_take_chunk(pool, NULL, &chunk);
+		if(task)
+			itu_sys_physics_pool_run_chunk(pool, task, chunk, worker_index);
+		else
+			SDL_WaitCondition(pool->cond_work, pool->mutex);
+	}
+	SDL_UnlockMutex(pool->mutex);
+	return 0;
+}
+
+// waits for every queued task to complete (helping with any of them), then empties the queue
+// NOTE: must be called with the pool mutex locked
+static void itu_sys_physics_pool_flush(PhysicsWorkerPool* pool)
+{
+	for(int i = 0; i < pool->tasks_count; ++i)
+	{
+		PhysicsTask* task = &pool->tasks[i];
+		while(task->chunks_done < task->chunks_count)
+		{
+			int chunk;
+			PhysicsTask* task_any = itu_sys_physics_pool_take_chunk(pool, NULL, &chunk);
+			if(task_any)
+				itu_sys_physics_pool_run_chunk(pool, task_any, chunk, 0);
+			else
+				SDL_WaitCondition(pool->cond_done, pool->mutex);
+		}
+	}
+	pool->tasks_flushed += pool->tasks_count;
+	pool->tasks_count = 0;
+}
+
+// tasks are returned to box2d as tickets (their index in the step + 1) instead of pointers, since slots are reused
+// after a flush
+// NOTE: every task goes through the pool, even single item ones. Box2D solver stages are enqueued as one `(1, 1)` task
+//       per worker that sync with each other, so running one inline would serialize the whole constraint solve
+//       (or deadlock, if worker 0 wasn't enqueued yet)
+static void* itu_sys_physics_enqueue_task(b2TaskCallback* fn_task, int item_count, int min_range, void* task_context, void* user_context)
+{
+	PhysicsWorkerPool* pool = (PhysicsWorkerPool*)user_context;
+	if(item_count <= 0)
+		return NULL;
+
+	// a few chunks per worker, so that faster workers can pick up the slack
+	min_range = SDL_max(min_range, 1);
+	int chunks_count = SDL_min((item_count + min_range - 1) / min_range, pool->workers_count * 4);
+
+	SDL_LockMutex(pool->mutex);
+	if(pool->tasks_count == PHYSICS_TASKS_MAX)
+		itu_sys_physics_pool_flush(pool);
+
+	int ticket = pool->tasks_flushed + pool->tasks_count;
+	PhysicsTask* task = &pool->tasks[pool->tasks_count++];
+	task->fn_task = fn_task;
+	task->task_context = task_context;
+	task->item_count = item_count;
+	task->chunk_size = (item_count + chunks_count - 1) / chunks_count;
+	task->chunks_count = (item_count + task->chunk_size - 1) / task->chunk_size;
+	task->chunks_next = 0;
+	task->chunks_done = 0;
+	SDL_BroadcastCondition(pool->cond_work);
+	SDL_UnlockMutex(pool->mutex);
+
+	return (void*)(intptr_t)(ticket + 1);
+}
+
+static void itu_sys_physics_finish_task(void* user_task, void* user_context)
+{
+	PhysicsWorkerPool* pool = (PhysicsWorkerPool*)user_context;
+	if(!user_task)
+		return;
+	int ticket = (int)(intptr_t)user_task - 1;
+
+	// main thread helps with what's left, then waits for the chunks still running on other workers
+	SDL_LockMutex(pool->mutex);
+	if(ticket < pool->tasks_flushed)
+	{
+		// completed during a flush
+		SDL_UnlockMutex(pool->mutex);
+		return;
+	}
+
+	PhysicsTask* task = &pool->tasks[ticket - pool->tasks_flushed];
+	while(task->chunks_done < task->chunks_count)
+	{
+		int chunk;
+		if(itu_sys_physics_pool_take_chunk(pool, task, &chunk))
+			itu_sys_physics_pool_run_chunk(pool, task, chunk, 0);
+		else
+			SDL_WaitCondition(pool->cond_done, pool->mutex);
+	}
+	SDL_UnlockMutex(pool->mutex);
+}
+
+static void itu_sys_physics_pool_stop()
+{
+	PhysicsWorkerPool* pool = &sys_physics_data.pool;
+	if(!pool->mutex)
+		return;
+
+	SDL_LockMutex(pool->mutex);
+	pool->quit = true;
+	SDL_BroadcastCondition(pool->cond_work);
+	SDL_UnlockMutex(pool->mutex);
+
+	for(int i = 1; i < pool->workers_count; ++i)
+		SDL_WaitThread(pool->threads[i], NULL);
+
+	SDL_DestroyCondition(pool->cond_done);
+	SDL_DestroyCondition(pool->cond_work);
+	SDL_DestroyMutex(pool->mutex);
+	SDL_zerop(pool);
+}
+
+static void itu_sys_physics_pool_start(int workers_count)
+{
+	PhysicsWorkerPool* pool = &sys_physics_data.pool;
+	if(workers_count == pool->workers_count)
+		return;
+
+	itu_sys_physics_pool_stop();
+	pool->workers_count = 1;
+	if(workers_count <= 1)
+		return;
+
+	pool->mutex = SDL_CreateMutex();
+	pool->cond_work = SDL_CreateCondition();
+	pool->cond_done = SDL_CreateCondition();
+	for(int i = 1; i < workers_count; ++i)
+	{
+		char name[32];
+		SDL_snprintf(name, sizeof(name), "physics_worker_%d", i);
+		pool->threads[i] = SDL_CreateThread(itu_sys_physics_pool_worker, name, (void*)(intptr_t)i);
+		if(!pool->threads[i])
+		{
+			SDL_Log("WARNING can't create physics worker thread: %s\n", SDL_GetError());
+			break;
+		}
+		pool->workers_count++;
+	}
+}
+
 void fn_box2d_wrapper_draw_polygon(b2Transform transform, const b2Vec2* vertices, int vertexCount, float radius, b2HexColor color, void* context);
 void fn_box2d_wrapper_draw_circle(b2Transform transform, float radius, b2HexColor b2_color, void* context);
 void fn_box2d_wrapper_draw_capsule(b2Vec2 p1, b2Vec2 p2, float radius, b2HexColor b2_color, void* context);
+void fn_box2d_wrapper_draw_polygon_outline(const b2Vec2* vertices, int vertexCount, b2HexColor b2_color, void* context);
+void fn_box2d_wrapper_draw_circle_outline(b2Vec2 center, float radius, b2HexColor b2_color, void* context);
+void fn_box2d_wrapper_draw_segment(b2Vec2 p1, b2Vec2 p2, b2HexColor b2_color, void* context);
+void fn_box2d_wrapper_draw_transform(b2Transform transform, void* context);
+void fn_box2d_wrapper_draw_point(b2Vec2 p, float size, b2HexColor b2_color, void* context);
+void fn_box2d_wrapper_draw_string(b2Vec2 p, const char* s, b2HexColor b2_color, void* context);
 
 void itu_sys_physics_init(SDLContext* context)
 {
+	sys_physics_data.workers_count_requested = PHYSICS_WORKERS_COUNT;
+	sys_physics_data.budget.budget = PHYSICS_BUDGET_NSECS;
+	sys_physics_data.budget.stats.substeps_count = PHYSICS_SUBSTEPS_MAX;
+
+	PhysicsPoses* poses = &sys_physics_data.poses;
+	poses->slot_generation = (Uint32*)SDL_calloc(ENTITIES_COUNT_MAX, sizeof(Uint32));
+	poses->moved_frame     = (Uint32*)SDL_calloc(ENTITIES_COUNT_MAX, sizeof(Uint32));
+	poses->active_generation = (Uint32*)SDL_calloc(ENTITIES_COUNT_MAX, sizeof(Uint32));
+	poses->prev_x          = (float*) SDL_calloc(ENTITIES_COUNT_MAX, sizeof(float));
+	poses->prev_y          = (float*) SDL_calloc(ENTITIES_COUNT_MAX, sizeof(float));
+	poses->prev_angle      = (float*) SDL_calloc(ENTITIES_COUNT_MAX, sizeof(float));
+	poses->curr_x          = (float*) SDL_calloc(ENTITIES_COUNT_MAX, sizeof(float));
+	poses->curr_y          = (float*) SDL_calloc(ENTITIES_COUNT_MAX, sizeof(float));
+	poses->curr_angle      = (float*) SDL_calloc(ENTITIES_COUNT_MAX, sizeof(float));
+
 	// debug draw
+	// NOTE: box2d calls the draw functions without checking them, so all of them must be set
+	//       (even the ones only used by options we don't enable by default, like joints and contacts)
+	sys_physics_data.debug_draw = b2DefaultDebugDraw();
 	sys_physics_data.debug_draw.context = context;
 	sys_physics_data.debug_draw.drawShapes = true;
+	sys_physics_data.debug_draw.DrawPolygonFcn = fn_box2d_wrapper_draw_polygon_outline;
 	sys_physics_data.debug_draw.DrawSolidPolygonFcn = fn_box2d_wrapper_draw_polygon;
+	sys_physics_data.debug_draw.DrawCircleFcn = fn_box2d_wrapper_draw_circle_outline;
 	sys_physics_data.debug_draw.DrawSolidCircleFcn = fn_box2d_wrapper_draw_circle;
 	sys_physics_data.debug_draw.DrawSolidCapsuleFcn = fn_box2d_wrapper_draw_capsule;
+	sys_physics_data.debug_draw.DrawSegmentFcn = fn_box2d_wrapper_draw_segment;
+	sys_physics_data.debug_draw.DrawTransformFcn = fn_box2d_wrapper_draw_transform;
+	sys_physics_data.debug_draw.DrawPointFcn = fn_box2d_wrapper_draw_point;
+	sys_physics_data.debug_draw.DrawStringFcn = fn_box2d_wrapper_draw_string;
 }
 
+// NOTE: if `world_def` doesn't provide its own task system, the physics system worker pool is used
 void itu_sys_physics_reset(const b2WorldDef* world_def)
 {
 	if(b2World_IsValid(sys_physics_data.world_id))
 		b2DestroyWorld(sys_physics_data.world_id);
 
-	stbds_hmfree(sys_physics_data.map_b2body_entity);
-	sys_physics_data.world_id = b2CreateWorld(world_def);
+	sys_physics_data.budget.stats.dropped_total = 0;
+
+	// pooled bodies are gone with the world
+	for(int i = 0; i < stbds_arrlen(sys_physics_data.body_pools); ++i)
+		stbds_arrfree(sys_physics_data.body_pools[i].bodies_free);
+	stbds_arrsetlen(sys_physics_data.body_pools, 0);
+	stbds_arrsetlen(sys_physics_data.bodies, 0);
+
+	// all bodies are gone, so are their poses
+	SDL_memset(sys_physics_data.poses.slot_generation, 0, ENTITIES_COUNT_MAX * sizeof(Uint32));
+	SDL_memset(sys_physics_data.poses.active_generation, 0, ENTITIES_COUNT_MAX * sizeof(Uint32));
+	stbds_arrsetlen(sys_physics_data.poses.active, 0);
+
+	b2WorldDef world_def_curr = *world_def;
+	if(!world_def_curr.enqueueTask)
+	{
+		int workers_count = sys_physics_data.workers_count_requested;
+		if(workers_count <= 0)
+			workers_count = SDL_GetNumLogicalCPUCores();
+		workers_count = SDL_clamp(workers_count, 1, PHYSICS_WORKERS_MAX);
+		itu_sys_physics_pool_start(workers_count);
+
+		if(sys_physics_data.pool.workers_count > 1)
+		{
+			world_def_curr.workerCount = sys_physics_data.pool.workers_count;
+			world_def_curr.enqueueTask = itu_sys_physics_enqueue_task;
+			world_def_curr.finishTask = itu_sys_physics_finish_task;
+			world_def_curr.userTaskContext = &sys_physics_data.pool;
+		}
+	}
+	sys_physics_data.world_id = b2CreateWorld(&world_def_curr);
 }
 
 void itu_sys_physics_step(float fixed_delta)
 {
-	b2World_Step(sys_physics_data.world_id, fixed_delta, 4);
+	// all tasks from the previous step are done, slots can be reused
+	PhysicsWorkerPool* pool = &sys_physics_data.pool;
+	if(pool->mutex)
+	{
+		SDL_LockMutex(pool->mutex);
+		pool->tasks_count = 0;
+		pool->tasks_flushed = 0;
+		SDL_UnlockMutex(pool->mutex);
+	}
+
+	Uint64 time_beg = SDL_GetTicksNS();
+	b2World_Step(sys_physics_data.world_id, fixed_delta, sys_physics_data.budget.stats.substeps_count);
+	Uint64 time_end = SDL_GetTicksNS();
+
+	// exponential moving average, so that a single spike doesn't change the number of steps we can afford
+	PhysicsBudget* budget = &sys_physics_data.budget;
+	float cost = (float)(time_end - time_beg);
+	budget->step_cost_avg = budget->step_cost_avg == 0 ? cost : lerp(budget->step_cost_avg, cost, 0.1f);
+	budget->stats.step_cost_ms = budget->step_cost_avg / (float)MILLIS(1);
+}
+
+void itu_sys_physics_set_budget(SDL_Time budget_ns)
+{
+	sys_physics_data.budget.budget = budget_ns;
+}
+
+// how many steps fit in the budget this frame (at least 1, so that the simulation never stops completely)
+int itu_sys_physics_budget_get_steps_allowed(int steps_max)
+{
+	PhysicsBudget* budget = &sys_physics_data.budget;
+	budget->steps_max = steps_max;
+	int steps_allowed = steps_max;
+	if(budget->step_cost_avg > 0)
+		steps_allowed = SDL_clamp((int)(budget->budget / budget->step_cost_avg), 1, steps_max);
+
+	budget->stats.steps_allowed = steps_allowed;
+	return steps_allowed;
+}
+
+// `dropped_ns` is the simulation time that couldn't be stepped this frame
+void itu_sys_physics_budget_frame_end(SDL_Time dropped_ns)
+{
+	// how many consecutive frames before switching quality tier (relaxing is slower, to avoid oscillating)
+	const int frames_to_degrade = 30;
+	const int frames_to_improve = 120;
+
+	PhysicsBudget* budget = &sys_physics_data.budget;
+	budget->stats.dropped_frame = dropped_ns;
+	budget->stats.dropped_total += dropped_ns;
+
+	if(dropped_ns > 0)
+	{
+		// NOTE: rate limited, this can happen every frame
+		Uint64 ticks = SDL_GetTicksNS();
+		if(ticks - budget->last_warning_ticks > SECONDS(1))
+		{
+			SDL_Log("WARNING physics over budget (step %.3f ms, %d substeps), dropped %.3f ms of simulation\n", budget->stats.step_cost_ms, budget->stats.substeps_count, NS_TO_MILLIS(dropped_ns));
+			budget->last_warning_ticks = ticks;
+		}
+
+		budget->frames_relaxed = 0;
+		budget->frames_overloaded++;
+		if(budget->frames_overloaded >= frames_to_degrade && budget->stats.substeps_count > PHYSICS_SUBSTEPS_MIN)
+		{
+			budget->stats.substeps_count--;
+			budget->frames_overloaded = 0;
+		}
+	}
+	else
+	{
+		// plenty of room even if we had to run the max number of steps at a higher tier
+		budget->frames_overloaded = 0;
+		int steps_max = SDL_max(budget->steps_max, 1);
+		bool relaxed = budget->step_cost_avg * steps_max * PHYSICS_SUBSTEPS_MAX / budget->stats.substeps_count < budget->budget;
+		budget->frames_relaxed = relaxed ? budget->frames_relaxed + 1 : 0;
+		if(budget->frames_relaxed >= frames_to_improve && budget->stats.substeps_count < PHYSICS_SUBSTEPS_MAX)
+		{
+			budget->stats.substeps_count++;
+			budget->frames_relaxed = 0;
+		}
+	}
+}
+
+PhysicsBudgetStats itu_sys_physics_get_budget_stats()
+{
+	return sys_physics_data.budget.stats;
+}
+
+// takes effect on next `itu_sys_physics_reset()` (box2d worlds can't change worker count after creation)
+// 0 means one worker for each logical core
+// NOTE: `itu_sys_physics_init()` sets it back to PHYSICS_WORKERS_COUNT
+void itu_sys_physics_set_workers_count(int count)
+{
+	sys_physics_data.workers_count_requested = count;
+}
+
+// number of threads used by the current world (including the main thread)
+int itu_sys_physics_get_workers_count()
+{
+	return SDL_max(sys_physics_data.pool.workers_count, 1);
+}
+
+// timings of the last step (in milliseconds)
+b2Profile itu_sys_physics_get_profile()
+{
+	return b2World_GetProfile(sys_physics_data.world_id);
+}
+
+static void* itu_sys_physics_entity_to_user_data(ITU_EntityId id)
+{
+	ITU_EntityId packed = id;
+	packed.index += 1;
+	return value_cast(void*, packed);
+}
+
+static ITU_EntityId itu_sys_physics_user_data_to_entity(void* user_data)
+{
+	if(!user_data)
+	{
+		ITU_EntityId ret = ITU_ENTITY_ID_NULL;
+		return ret;
+	}
+
+	ITU_EntityId ret = value_cast(ITU_EntityId, user_data);
+	ret.index -= 1;
+	return ret;
+}
+
+// NOTE: the entity is stored as body user data (overriding the one in `body_def`)
+b2BodyId itu_sys_physics_add_body(ITU_EntityId entity, b2BodyDef* body_def)
+{
+	return itu_sys_physics_add_body_untyped(itu_sys_physics_entity_to_user_data(entity), body_def);
+}
+
+// same as `itu_sys_physics_add_body()`, but `user_data` is stored as is (ie, for games not using the entity storage)
+// NOTE: untyped bodies can't go through the physics system (`itu_system_physics()`) or the entity mapping functions,
+//       their user data can only be read back with `itu_sys_physics_get_entity()`
+b2BodyId itu_sys_physics_add_body_untyped(void* user_data, b2BodyDef* body_def)
+{
+	b2BodyDef body_def_curr = *body_def;
+	body_def_curr.userData = user_data;
+	b2BodyId ret = b2CreateBody(sys_physics_data.world_id, &body_def_curr);
+	stbds_arrput(sys_physics_data.bodies, ret);
+
+	return ret;
+}
+
+// NOTE: the shape gets the same user data of its body, so that contact and sensor events don't need to go through the body
+b2ShapeId itu_sys_physics_add_shape(b2BodyId body_id, b2ShapeDef* shape_def, ITU_PhysicsShape* shape)
+{
+	b2ShapeDef shape_def_curr = *shape_def;
+	shape_def_curr.userData = b2Body_GetUserData(body_id);
+	switch(shape->type)
+	{
+		case b2_circleShape : return b2CreateCircleShape (body_id, &shape_def_curr, &shape->circle);
+		case b2_capsuleShape: return b2CreateCapsuleShape(body_id, &shape_def_curr, &shape->capsule);
+		case b2_polygonShape: return b2CreatePolygonShape(body_id, &shape_def_curr, &shape->polygon);
+		default:
+			SDL_Log("WARNING shape type %d not supported\n", shape->type);
+			return b2_nullShapeId;
+	}
+}
+
+// creates `count` bodies (and their shape) from the same definitions, only changing their position
+// NOTE: box2d doesn't have a bulk creation API, but we still save all the setup work done by callers for every single body
+// NOTE: entities are stored as body user data, same as `itu_sys_physics_add_body()`
+void itu_sys_physics_add_bodies(ITU_EntityId* entities, int count, b2BodyDef* body_def, b2ShapeDef* shape_def, ITU_PhysicsShape* shape, vec2f* positions, b2BodyId* out_body_ids, b2ShapeId* out_shape_ids)
+{
+	b2BodyDef body_def_curr = *body_def;
+	for(int i = 0; i < count; ++i)
+	{
+		if(positions)
+			body_def_curr.position = value_cast(b2Vec2, positions[i]);
+
+		b2BodyId body_id = itu_sys_physics_add_body(entities[i], &body_def_curr);
+		out_body_ids[i] = body_id;
+
+		if(shape)
+		{
+			b2ShapeId shape_id = itu_sys_physics_add_shape(body_id, shape_def, shape);
+			if(out_shape_ids)
+				out_shape_ids[i] = shape_id;
+		}
+	}
+}
+
+static b2BodyId itu_sys_physics_body_pool_add_body(PhysicsBodyPool* pool)
+{
+	b2BodyDef body_def = pool->body_def;
+	body_def.isEnabled = false;
+	b2BodyId ret = b2CreateBody(sys_physics_data.world_id, &body_def);
+	stbds_arrput(sys_physics_data.bodies, ret);
+	itu_sys_physics_add_shape(ret, &pool->shape_def, &pool->shape);
+	pool->bodies_count++;
+
+	return ret;
+}
+
+// returns the pool index, to be used in all other pool functions
+int itu_sys_physics_body_pool_create(b2BodyDef* body_def, b2ShapeDef* shape_def, ITU_PhysicsShape* shape, int capacity)
+{
+	PhysicsBodyPool pool;
+	SDL_zero(pool);
+	pool.body_def = *body_def;
+	pool.shape_def = *shape_def;
+	pool.shape = *shape;
+
+	// NOTE: the free list never needs to grow, unless we go over capacity
+	stbds_arrsetcap(pool.bodies_free, capacity);
+	for(int i = 0; i < capacity; ++i)
+		stbds_arrput(pool.bodies_free, itu_sys_physics_body_pool_add_body(&pool));
+
+	stbds_arrput(sys_physics_data.body_pools, pool);
+	return (int)stbds_arrlen(sys_physics_data.body_pools) - 1;
+}
+
+// NOTE: the body is reset (no velocity) and gets the entity as user data, same as `itu_sys_physics_add_body()`
+b2BodyId itu_sys_physics_body_pool_acquire(int pool_idx, ITU_EntityId entity, vec2f position, float angle)
+{
+	SDL_assert(pool_idx >= 0 && pool_idx < stbds_arrlen(sys_physics_data.body_pools));
+	PhysicsBodyPool* pool = &sys_physics_data.body_pools[pool_idx];
+
+	b2BodyId ret;
+	if(stbds_arrlen(pool->bodies_free) > 0)
+	{
+		ret = stbds_arrpop(pool->bodies_free);
+	}
+	else
+	{
+		// NOTE: logged only once, this is going to happen again until the pool is big enough
+		if(!pool->warned_exhausted)
+			SDL_Log("WARNING body pool %d exhausted (capacity %d), creating new bodies on demand\n", pool_idx, pool->bodies_count);
+		pool->warned_exhausted = true;
+		ret = itu_sys_physics_body_pool_add_body(pool);
+	}
+
+	b2ShapeId shape_id;
+	b2Body_GetShapes(ret, &shape_id, 1);
+	void* user_data = itu_sys_physics_entity_to_user_data(entity);
+	b2Body_SetUserData(ret, user_data);
+	b2Shape_SetUserData(shape_id, user_data);
+
+	b2Body_SetTransform(ret, value_cast(b2Vec2, position), b2MakeRot(angle));
+	b2Body_SetLinearVelocity(ret, b2Vec2_zero);
+	b2Body_SetAngularVelocity(ret, 0);
+	b2Body_Enable(ret);
+
+	return ret;
+}
+
+void itu_sys_physics_body_pool_release(int pool_idx, b2BodyId body_id)
+{
+	SDL_assert(pool_idx >= 0 && pool_idx < stbds_arrlen(sys_physics_data.body_pools));
+	PhysicsBodyPool* pool = &sys_physics_data.body_pools[pool_idx];
+
+	b2Body_Disable(body_id);
+	stbds_arrput(pool->bodies_free, body_id);
 }
 
-b2BodyId itu_sys_physics_add_body(void* entity, b2BodyDef* body_def)
+int itu_sys_physics_body_pool_get_acquired_count(int pool_idx)
 {
-	b2BodyId ret = b2CreateBody(sys_physics_data.world_id, body_def);
-	stbds_hmput(sys_physics_data.map_b2body_entity, ret, entity);
+	PhysicsBodyPool* pool = &sys_physics_data.body_pools[pool_idx];
+	return pool->bodies_count - (int)stbds_arrlen(pool->bodies_free);
+}
+
+#define PHYSICS_SNAPSHOT_FLAG_AWAKE   0x1
+#define PHYSICS_SNAPSHOT_FLAG_ENABLED 0x2
+
+PhysicsSnapshot* itu_sys_physics_snapshot_save(ITU_Arena* arena)
+{
+	// forget destroyed bodies, so that we don't pay for them in every snapshot
+	int bodies_count = 0;
+	for(int i = 0; i < stbds_arrlen(sys_physics_data.bodies); ++i)
+		if(b2Body_IsValid(sys_physics_data.bodies[i]))
+			sys_physics_data.bodies[bodies_count++] = sys_physics_data.bodies[i];
+	stbds_arrsetlen(sys_physics_data.bodies, bodies_count);
+
+	// single allocation, arrays are laid out one after the other (biggest alignment first)
+	Uint64 size = sizeof(PhysicsSnapshot)
+	            + sizeof(b2BodyId)    * bodies_count
+	            + sizeof(b2Transform) * bodies_count
+	            + sizeof(b2Vec2)      * bodies_count
+	            + sizeof(float)       * bodies_count
+	            + sizeof(Uint8)       * bodies_count;
+	PhysicsSnapshot* ret = (PhysicsSnapshot*)itu_lib_arena_alloc(arena, size, alignof(PhysicsSnapshot));
+	if(!ret)
+		return NULL;
+
+	ret->bodies_count = bodies_count;
+	ret->substeps_count = sys_physics_data.budget.stats.substeps_count;
+	ret->body_ids           = (b2BodyId*)   (ret + 1);
+	ret->transforms         = (b2Transform*)(ret->body_ids + bodies_count);
+	ret->velocities         = (b2Vec2*)     (ret->transforms + bodies_count);
+	ret->angular_velocities = (float*)      (ret->velocities + bodies_count);
+	ret->flags              = (Uint8*)      (ret->angular_velocities + bodies_count);
+
+	for(int i = 0; i < bodies_count; ++i)
+	{
+		b2BodyId body_id = sys_physics_data.bodies[i];
+		ret->body_ids[i]           = body_id;
+		ret->transforms[i]         = b2Body_GetTransform(body_id);
+		ret->velocities[i]         = b2Body_GetLinearVelocity(body_id);
+		ret->angular_velocities[i] = b2Body_GetAngularVelocity(body_id);
+		ret->flags[i]              = (b2Body_IsAwake(body_id)   ? PHYSICS_SNAPSHOT_FLAG_AWAKE   : 0)
+		                           | (b2Body_IsEnabled(body_id) ? PHYSICS_SNAPSHOT_FLAG_ENABLED : 0);
+	}
 
 	return ret;
 }
 
+// NOTE: interpolation poses of restored bodies are reset too, so that rendering doesn't blend across the rewind,
+//       and their `Transform`/`PhysicsData` are written right away (sleeping bodies won't send move events)
+void itu_sys_physics_snapshot_restore(PhysicsSnapshot* snapshot)
+{
+	PhysicsPoses* poses = &sys_physics_data.poses;
+
+	sys_physics_data.budget.stats.substeps_count = snapshot->substeps_count;
+	for(int i = 0; i < snapshot->bodies_count; ++i)
+	{
+		b2BodyId body_id = snapshot->body_ids[i];
+		if(!b2Body_IsValid(body_id))
+			continue;
+
+		Uint8 flags = snapshot->flags[i];
+		b2Transform transform = snapshot->transforms[i];
+
+		// enable first, disabled bodies ignore everything else
+		if(flags & PHYSICS_SNAPSHOT_FLAG_ENABLED)
+			b2Body_Enable(body_id);
+		b2Body_SetTransform(body_id, transform.p, transform.q);
+		b2Body_SetLinearVelocity(body_id, snapshot->velocities[i]);
+		b2Body_SetAngularVelocity(body_id, snapshot->angular_velocities[i]);
+		b2Body_SetAwake(body_id, flags & PHYSICS_SNAPSHOT_FLAG_AWAKE);
+		if(!(flags & PHYSICS_SNAPSHOT_FLAG_ENABLED))
+			b2Body_Disable(body_id);
+
+		ITU_EntityId id = itu_sys_physics_body_get_entity(body_id);
+		if(!itu_entity_is_valid(id))
+			continue;
+
+		float angle = b2Rot_GetAngle(transform.q);
+		if(poses->slot_generation[id.index] == id.generation + 1)
+		{
+			poses->prev_x[id.index]     = poses->curr_x[id.index]     = transform.p.x;
+			poses->prev_y[id.index]     = poses->curr_y[id.index]     = transform.p.y;
+			poses->prev_angle[id.index] = poses->curr_angle[id.index] = angle;
+		}
+
+		PhysicsData* physics_data = entity_get_data(id, PhysicsData);
+		Transform* data_transform = entity_get_data(id, Transform);
+		if(!physics_data || !data_transform)
+			continue;
+
+		physics_data->velocity = value_cast(vec2f, snapshot->velocities[i]);
+		physics_data->torque   = snapshot->angular_velocities[i];
+		physics_data->synced_velocity = physics_data->velocity;
+		physics_data->synced_torque   = physics_data->torque;
+		if(!physics_data->ignore_position)
+			data_transform->position = value_cast(vec2f, transform.p);
+		if(!physics_data->ignore_rotation)
+			data_transform->rotation = angle;
+	}
+}
+
+ITU_EntityId itu_sys_physics_body_get_entity(b2BodyId body_id)
+{
+	return itu_sys_physics_user_data_to_entity(b2Body_GetUserData(body_id));
+}
+
+// NOTE: shapes not created through `itu_sys_physics_add_shape()` don't have user data, so we go through their body
+ITU_EntityId itu_sys_physics_shape_get_entity(b2ShapeId shape_id)
+{
+	void* user_data = b2Shape_GetUserData(shape_id);
+	if(!user_data)
+		user_data = b2Body_GetUserData(b2Shape_GetBody(shape_id));
+	return itu_sys_physics_user_data_to_entity(user_data);
+}
+
+// same as `itu_sys_physics_body_get_entity()`, but untyped (ie, the `void*` passed to `itu_sys_physics_add_body_untyped()`)
 void* itu_sys_physics_get_entity(b2BodyId body_id)
 {
-	return stbds_hmget(sys_physics_data.map_b2body_entity, body_id);
+	return b2Body_GetUserData(body_id);
 }
 
 b2SensorEvents ity_sys_physics_get_sensor_events()
@@ -111,84 +998,522 @@ b2SensorEvents ity_sys_physics_get_sensor_events()
 	return ret;
 }
 
+// move events of the last step (one for each body that is awake, or that just fell asleep)
+b2BodyEvents itu_sys_physics_get_body_events()
+{
+	return b2World_GetBodyEvents(sys_physics_data.world_id);
+}
+
+// runs `fn_task` over `count` items on the worker pool (or inline, if there are no workers)
+static void itu_sys_physics_pool_run(b2TaskCallback* fn_task, int count, void* task_context)
+{
+	PhysicsWorkerPool* pool = &sys_physics_data.pool;
+	if(pool->workers_count <= 1)
+	{
+		fn_task(0, count, 0, task_context);
+		return;
+	}
+
+	// NOTE: outside of `b2World_Step()` nothing else is in flight
+	SDL_LockMutex(pool->mutex);
+	pool->tasks_count = 0;
+	pool->tasks_flushed = 0;
+	SDL_UnlockMutex(pool->mutex);
+
+	void* task = itu_sys_physics_enqueue_task(fn_task, count, PHYSICS_QUERIES_MIN_RANGE, task_context, pool);
+	itu_sys_physics_finish_task(task, pool);
+}
+
+static b2ShapeProxy itu_sys_physics_shape_make_proxy(ITU_PhysicsShape* shape, vec2f position, float angle)
+{
+	b2Vec2 p = value_cast(b2Vec2, position);
+	b2Rot  q = b2MakeRot(angle);
+	switch(shape->type)
+	{
+		case b2_circleShape : return b2MakeOffsetProxy(&shape->circle.center, 1, shape->circle.radius, p, q);
+		case b2_capsuleShape: return b2MakeOffsetProxy(&shape->capsule.center1, 2, shape->capsule.radius, p, q);
+		case b2_polygonShape: return b2MakeOffsetProxy(shape->polygon.vertices, shape->polygon.count, shape->polygon.radius, p, q);
+		default:
+			SDL_Log("WARNING shape type %d not supported\n", shape->type);
+			return b2MakeOffsetProxy(&p, 1, 0, b2Vec2_zero, b2Rot_identity);
+	}
+}
+
+// a batch of queries of one kind, split between workers
+struct PhysicsQueryBatch
+{
+	void* queries;
+	void* out;
+	ITU_EntityId* results; // `results_max` for each query, for overlap queries
+	int results_max;
+	b2QueryFilter filter;
+};
+
+// overlap results of a single query
+struct PhysicsQueryOverlapsContext
+{
+	PhysicsQueryOverlaps* out;
+	int results_max;
+};
+
+static bool fn_box2d_wrapper_query_overlap(b2ShapeId shape_id, void* context)
+{
+	PhysicsQueryOverlapsContext* ctx = (PhysicsQueryOverlapsContext*)context;
+	PhysicsQueryOverlaps* out = ctx->out;
+	ITU_EntityId entity = itu_sys_physics_shape_get_entity(shape_id);
+
+	// results are few, a linear search is fine
+	for(int i = 0; i < out->count; ++i)
+		if(out->ids[i].index == entity.index && out->ids[i].generation == entity.generation)
+			return true;
+
+	out->ids[out->count++] = entity;
+	return out->count < ctx->results_max;
+}
+
+static float fn_box2d_wrapper_query_cast_closest(b2ShapeId shape_id, b2Vec2 point, b2Vec2 normal, float fraction, void* context)
+{
+	PhysicsQueryHit* out = (PhysicsQueryHit*)context;
+	out->entity = itu_sys_physics_shape_get_entity(shape_id);
+	out->point = value_cast(vec2f, point);
+	out->normal = value_cast(vec2f, normal);
+	out->fraction = fraction;
+	out->hit = true;
+
+	// clip the cast, so that only closer shapes are reported from now on
+	return fraction;
+}
+
+static void itu_sys_physics_query_aabb_task(int start, int end, uint32_t worker_index, void* task_context)
+{
+	PhysicsQueryBatch* batch = (PhysicsQueryBatch*)task_context;
+	PhysicsQueryAABB* queries = (PhysicsQueryAABB*)batch->queries;
+	PhysicsQueryOverlaps* out = (PhysicsQueryOverlaps*)batch->out;
+	for(int i = start; i < end; ++i)
+	{
+		out[i].ids = batch->results + i * batch->results_max;
+		out[i].count = 0;
+
+		PhysicsQueryOverlapsContext ctx = { &out[i], batch->results_max };
+		b2AABB aabb = { value_cast(b2Vec2, queries[i].min), value_cast(b2Vec2, queries[i].max) };
+		b2World_OverlapAABB(sys_physics_data.world_id, aabb, batch->filter, fn_box2d_wrapper_query_overlap, &ctx);
+	}
+}
+
+static void itu_sys_physics_query_circle_task(int start, int end, uint32_t worker_index, void* task_context)
+{
+	PhysicsQueryBatch* batch = (PhysicsQueryBatch*)task_context;
+	PhysicsQueryCircle* queries = (PhysicsQueryCircle*)batch->queries;
+	PhysicsQueryOverlaps* out = (PhysicsQueryOverlaps*)batch->out;
+	for(int i = start; i < end; ++i)
+	{
+		out[i].ids = batch->results + i * batch->results_max;
+		out[i].count = 0;
+
+		PhysicsQueryOverlapsContext ctx = { &out[i], batch->results_max };
+		b2ShapeProxy proxy = b2MakeProxy(&value_cast(b2Vec2, queries[i].center), 1, queries[i].radius);
+		b2World_OverlapShape(sys_physics_data.world_id, &proxy, batch->filter, fn_box2d_wrapper_query_overlap, &ctx);
+	}
+}
+
+static void itu_sys_physics_query_ray_task(int start, int end, uint32_t worker_index, void* task_context)
+{
+	PhysicsQueryBatch* batch = (PhysicsQueryBatch*)task_context;
+	PhysicsQueryRay* queries = (PhysicsQueryRay*)batch->queries;
+	PhysicsQueryHit* out = (PhysicsQueryHit*)batch->out;
+	for(int i = start; i < end; ++i)
+	{
+		b2RayResult res = b2World_CastRayClosest(sys_physics_data.world_id, value_cast(b2Vec2, queries[i].origin), value_cast(b2Vec2, queries[i].translation), batch->filter);
+
+		out[i] = { 0 };
+		if(res.hit)
+		{
+			out[i].entity = itu_sys_physics_shape_get_entity(res.shapeId);
+			out[i].point = value_cast(vec2f, res.point);
+			out[i].normal = value_cast(vec2f, res.normal);
+			out[i].fraction = res.fraction;
+			out[i].hit = true;
+		}
+	}
+}
+
+static void itu_sys_physics_query_shape_cast_task(int start, int end, uint32_t worker_index, void* task_context)
+{
+	PhysicsQueryBatch* batch = (PhysicsQueryBatch*)task_context;
+	PhysicsQueryShapeCast* queries = (PhysicsQueryShapeCast*)batch->queries;
+	PhysicsQueryHit* out = (PhysicsQueryHit*)batch->out;
+	for(int i = start; i < end; ++i)
+	{
+		out[i] = { 0 };
+		b2ShapeProxy proxy = itu_sys_physics_shape_make_proxy(&queries[i].shape, queries[i].position, queries[i].angle);
+		b2World_CastShape(sys_physics_data.world_id, &proxy, value_cast(b2Vec2, queries[i].translation), batch->filter, fn_box2d_wrapper_query_cast_closest, &out[i]);
+	}
+}
+
+static PhysicsQueryOverlaps* itu_sys_physics_query_overlaps(b2TaskCallback* fn_task, void* queries, int count, b2QueryFilter filter, int results_max)
+{
+	SDL_assert(results_max > 0);
+
+	ITU_Arena* arena = itu_lib_arena_frame();
+	PhysicsQueryBatch batch;
+	batch.queries = queries;
+	batch.out = arena_push_array(arena, PhysicsQueryOverlaps, count);
+	batch.results = arena_push_array(arena, ITU_EntityId, count * results_max);
+	batch.results_max = results_max;
+	batch.filter = filter;
+	if(!batch.out || !batch.results)
+		return NULL;
+
+	itu_sys_physics_pool_run(fn_task, count, &batch);
+	return (PhysicsQueryOverlaps*)batch.out;
+}
+
+static PhysicsQueryHit* itu_sys_physics_query_casts(b2TaskCallback* fn_task, void* queries, int count, b2QueryFilter filter)
+{
+	ITU_Arena* arena = itu_lib_arena_frame();
+	PhysicsQueryBatch batch;
+	batch.queries = queries;
+	batch.out = arena_push_array(arena, PhysicsQueryHit, count);
+	batch.results = NULL;
+	batch.results_max = 0;
+	batch.filter = filter;
+	if(!batch.out)
+		return NULL;
+
+	itu_sys_physics_pool_run(fn_task, count, &batch);
+	return (PhysicsQueryHit*)batch.out;
+}
+
+// NOTE: like `b2World_OverlapAABB()`, this reports every shape whose bounding box overlaps the query
+PhysicsQueryOverlaps* itu_sys_physics_query_aabb(PhysicsQueryAABB* queries, int count, b2QueryFilter filter, int results_max)
+{
+	return itu_sys_physics_query_overlaps(itu_sys_physics_query_aabb_task, queries, count, filter, results_max);
+}
+
+PhysicsQueryOverlaps* itu_sys_physics_query_circle(PhysicsQueryCircle* queries, int count, b2QueryFilter filter, int results_max)
+{
+	return itu_sys_physics_query_overlaps(itu_sys_physics_query_circle_task, queries, count, filter, results_max);
+}
+
+PhysicsQueryHit* itu_sys_physics_query_ray(PhysicsQueryRay* queries, int count, b2QueryFilter filter)
+{
+	return itu_sys_physics_query_casts(itu_sys_physics_query_ray_task, queries, count, filter);
+}
+
+PhysicsQueryHit* itu_sys_physics_query_shape_cast(PhysicsQueryShapeCast* queries, int count, b2QueryFilter filter)
+{
+	return itu_sys_physics_query_casts(itu_sys_physics_query_shape_cast_task, queries, count, filter);
+}
+
+void itu_sys_physics_poses_frame_begin()
+{
+	sys_physics_data.poses.frame++;
+}
+
+// stores the poses of all bodies that moved during the last step
+// NOTE: box2d only keeps move events for the last step, so this needs to be called after every step
+void itu_sys_physics_poses_read_step()
+{
+	PhysicsPoses* poses = &sys_physics_data.poses;
+	b2BodyEvents events = b2World_GetBodyEvents(sys_physics_data.world_id);
+	for(int i = 0; i < events.moveCount; ++i)
+	{
+		b2BodyMoveEvent* event = &events.moveEvents[i];
+		ITU_EntityId id = itu_sys_physics_user_data_to_entity(event->userData);
+		if(!itu_entity_is_valid(id))
+			continue;
+
+		int idx = id.index;
+		float x = event->transform.p.x;
+		float y = event->transform.p.y;
+		float angle = b2Rot_GetAngle(event->transform.q);
+
+		// first time we see this entity, or it just fell asleep: no interpolation
+		// (the latter because no more events are coming, and it should stay exactly where it stopped)
+		if(poses->slot_generation[idx] != id.generation + 1 || event->fellAsleep)
+		{
+			poses->slot_generation[idx] = id.generation + 1;
+			poses->prev_x[idx] = x;
+			poses->prev_y[idx] = y;
+			poses->prev_angle[idx] = angle;
+		}
+		else
+		{
+			poses->prev_x[idx] = poses->curr_x[idx];
+			poses->prev_y[idx] = poses->curr_y[idx];
+			poses->prev_angle[idx] = poses->curr_angle[idx];
+		}
+		poses->curr_x[idx] = x;
+		poses->curr_y[idx] = y;
+		poses->curr_angle[idx] = angle;
+
+		poses->moved_frame[idx] = poses->frame;
+		if(poses->active_generation[idx] != id.generation + 1)
+		{
+			poses->active_generation[idx] = id.generation + 1;
+			stbds_arrput(poses->active, id);
+		}
+	}
+}
+
+// returns the entities whose transform still has to follow their poses
+// NOTE: entities are dropped once their poses are identical and were already returned on a previous frame
+//       (their transform is exactly the last pose already), or when they don't own their slot anymore
+int itu_sys_physics_poses_get_active(ITU_EntityId** out_ids)
+{
+	PhysicsPoses* poses = &sys_physics_data.poses;
+	int count = stbds_arrlen(poses->active);
+	for(int i = count - 1; i >= 0; --i)
+	{
+		ITU_EntityId id = poses->active[i];
+		int idx = id.index;
+
+		bool is_owner = poses->slot_generation[idx] == id.generation + 1 && itu_entity_is_valid(id);
+		bool is_settled =
+			poses->moved_frame[idx] != poses->frame &&
+			poses->prev_x[idx] == poses->curr_x[idx] &&
+			poses->prev_y[idx] == poses->curr_y[idx] &&
+			poses->prev_angle[idx] == poses->curr_angle[idx];
+		if(is_owner && !is_settled)
+			continue;
+
+		if(poses->active_generation[idx] == id.generation + 1)
+			poses->active_generation[idx] = 0;
+		stbds_arrdelswap(poses->active, i);
+	}
+
+	*out_ids = poses->active;
+	return stbds_arrlen(poses->active);
+}
+
+// `alpha` is how far we are between the last two steps (0 = previous step, 1 = last step)
+void itu_sys_physics_poses_blend(ITU_EntityId id, float alpha, vec2f* out_position, float* out_angle)
+{
+	PhysicsPoses* poses = &sys_physics_data.poses;
+	int idx = id.index;
+	float alpha_inv = 1 - alpha;
+
+	out_position->x = poses->curr_x[idx] * alpha + poses->prev_x[idx] * alpha_inv;
+	out_position->y = poses->curr_y[idx] * alpha + poses->prev_y[idx] * alpha_inv;
+
+	// angles are in [-pi, pi], so we go through the shortest delta (a body spinning across the boundary would
+	// otherwise swing all the way around for one frame)
+	float delta_angle = b2UnwindAngle(poses->curr_angle[idx] - poses->prev_angle[idx]);
+	*out_angle = b2UnwindAngle(poses->prev_angle[idx] + delta_angle * alpha);
+}
+
+// `dt` is how much time passed since the last step
+void itu_sys_physics_poses_extrapolate(ITU_EntityId id, float dt, vec2f velocity, float angular_velocity, vec2f* out_position, float* out_angle)
+{
+	PhysicsPoses* poses = &sys_physics_data.poses;
+	int idx = id.index;
+
+	out_position->x = poses->curr_x[idx] + velocity.x * dt;
+	out_position->y = poses->curr_y[idx] + velocity.y * dt;
+	*out_angle      = poses->curr_angle[idx] + angular_velocity * dt;
+}
+
+// appends a contact to the ring buffer of `id` (if it has a `Contacts` component), clearing it on the first contact of a new frame
+static void itu_sys_physics_contacts_push(ITU_EntityId id, PhysicsContactType type, b2ShapeId shape, ITU_EntityId other, b2Vec2 normal, b2Vec2 point, float approach_speed)
+{
+	if(!itu_entity_is_valid(id))
+		return;
+	Contacts* contacts = entity_get_data(id, Contacts);
+	if(!contacts)
+		return;
+
+	Uint32 frame = sys_physics_data.poses.frame;
+	if(contacts->frame != frame)
+	{
+		contacts->frame = frame;
+		contacts->head = 0;
+		contacts->count = 0;
+	}
+
+	PhysicsContact* contact = &contacts->items[contacts->head];
+	contact->other = other;
+	contact->shape = shape;
+	contact->normal = value_cast(vec2f, normal);
+	contact->point = value_cast(vec2f, point);
+	contact->approach_speed = approach_speed;
+	contact->type = type;
+
+	contacts->head = (contacts->head + 1) % PHYSICS_MAX_CONTACTS_PER_ENTITY;
+	contacts->count++;
+}
+
+// shapes in end events may have been destroyed already
+static ITU_EntityId itu_sys_physics_shape_get_entity_safe(b2ShapeId shape_id)
+{
+	if(b2Shape_IsValid(shape_id))
+		return itu_sys_physics_shape_get_entity(shape_id);
+
+	ITU_EntityId ret = ITU_ENTITY_ID_NULL;
+	return ret;
+}
+
+// NOTE: like poses, box2d only keeps events for the last step, so this needs to be called after every step
+void itu_sys_physics_contacts_read_step()
+{
+	b2ContactEvents contact_events = b2World_GetContactEvents(sys_physics_data.world_id);
+	for(int i = 0; i < contact_events.beginCount; ++i)
+	{
+		b2ContactBeginTouchEvent* event = &contact_events.beginEvents[i];
+		ITU_EntityId id_a = itu_sys_physics_shape_get_entity(event->shapeIdA);
+		ITU_EntityId id_b = itu_sys_physics_shape_get_entity(event->shapeIdB);
+		b2Vec2 normal = event->manifold.normal;
+		b2Vec2 point = event->manifold.pointCount > 0 ? event->manifold.points[0].point : b2Vec2_zero;
+		itu_sys_physics_contacts_push(id_a, PHYSICS_CONTACT_BEGIN, event->shapeIdA, id_b, normal, point, 0);
+		itu_sys_physics_contacts_push(id_b, PHYSICS_CONTACT_BEGIN, event->shapeIdB, id_a, b2Neg(normal), point, 0);
+	}
+	for(int i = 0; i < contact_events.endCount; ++i)
+	{
+		b2ContactEndTouchEvent* event = &contact_events.endEvents[i];
+		ITU_EntityId id_a = itu_sys_physics_shape_get_entity_safe(event->shapeIdA);
+		ITU_EntityId id_b = itu_sys_physics_shape_get_entity_safe(event->shapeIdB);
+		itu_sys_physics_contacts_push(id_a, PHYSICS_CONTACT_END, event->shapeIdA, id_b, b2Vec2_zero, b2Vec2_zero, 0);
+		itu_sys_physics_contacts_push(id_b, PHYSICS_CONTACT_END, event->shapeIdB, id_a, b2Vec2_zero, b2Vec2_zero, 0);
+	}
+	for(int i = 0; i < contact_events.hitCount; ++i)
+	{
+		b2ContactHitEvent* event = &contact_events.hitEvents[i];
+		ITU_EntityId id_a = itu_sys_physics_shape_get_entity(event->shapeIdA);
+		ITU_EntityId id_b = itu_sys_physics_shape_get_entity(event->shapeIdB);
+		itu_sys_physics_contacts_push(id_a, PHYSICS_CONTACT_HIT, event->shapeIdA, id_b, event->normal, event->point, event->approachSpeed);
+		itu_sys_physics_contacts_push(id_b, PHYSICS_CONTACT_HIT, event->shapeIdB, id_a, b2Neg(event->normal), event->point, event->approachSpeed);
+	}
+
+	b2SensorEvents sensor_events = b2World_GetSensorEvents(sys_physics_data.world_id);
+	for(int i = 0; i < sensor_events.beginCount; ++i)
+	{
+		b2SensorBeginTouchEvent* event = &sensor_events.beginEvents[i];
+		ITU_EntityId id_sensor  = itu_sys_physics_shape_get_entity(event->sensorShapeId);
+		ITU_EntityId id_visitor = itu_sys_physics_shape_get_entity(event->visitorShapeId);
+		itu_sys_physics_contacts_push(id_sensor,  PHYSICS_SENSOR_BEGIN, event->sensorShapeId,  id_visitor, b2Vec2_zero, b2Vec2_zero, 0);
+		itu_sys_physics_contacts_push(id_visitor, PHYSICS_VISIT_BEGIN,  event->visitorShapeId, id_sensor,  b2Vec2_zero, b2Vec2_zero, 0);
+	}
+	for(int i = 0; i < sensor_events.endCount; ++i)
+	{
+		b2SensorEndTouchEvent* event = &sensor_events.endEvents[i];
+		ITU_EntityId id_sensor  = itu_sys_physics_shape_get_entity_safe(event->sensorShapeId);
+		ITU_EntityId id_visitor = itu_sys_physics_shape_get_entity_safe(event->visitorShapeId);
+		itu_sys_physics_contacts_push(id_sensor,  PHYSICS_SENSOR_END, event->sensorShapeId,  id_visitor, b2Vec2_zero, b2Vec2_zero, 0);
+		itu_sys_physics_contacts_push(id_visitor, PHYSICS_VISIT_END,  event->visitorShapeId, id_sensor,  b2Vec2_zero, b2Vec2_zero, 0);
+	}
+}
+
+// number of contacts available this frame (at most PHYSICS_MAX_CONTACTS_PER_ENTITY)
+int itu_sys_physics_contacts_count(Contacts* contacts)
+{
+	if(contacts->frame != sys_physics_data.poses.frame)
+		return 0;
+	return SDL_min(contacts->count, PHYSICS_MAX_CONTACTS_PER_ENTITY);
+}
+
+// oldest first
+PhysicsContact* itu_sys_physics_contacts_get(Contacts* contacts, int i)
+{
+	SDL_assert(i >= 0 && i < itu_sys_physics_contacts_count(contacts));
+
+	int count = itu_sys_physics_contacts_count(contacts);
+	int first = (contacts->head - count + PHYSICS_MAX_CONTACTS_PER_ENTITY) % PHYSICS_MAX_CONTACTS_PER_ENTITY;
+	return &contacts->items[(first + i) % PHYSICS_MAX_CONTACTS_PER_ENTITY];
+}
+
+// draws the physics world, skipping everything outside the active camera
+// NOTE: all shapes are accumulated and drawn together at the end (see `itu_lib_render_debug_begin()`)
 void itu_sys_physics_debug_draw()
 {
+	SDLContext* context = (SDLContext*)sys_physics_data.debug_draw.context;
+
+	SDL_FRect view = camera_get_world_rect(context, context->camera_active);
+	sys_physics_data.debug_draw.drawingBounds.lowerBound = b2Vec2{ view.x, view.y };
+	sys_physics_data.debug_draw.drawingBounds.upperBound = b2Vec2{ view.x + view.w, view.y + view.h };
+	sys_physics_data.debug_draw.useDrawingBounds = true;
+
+	itu_lib_render_debug_begin();
 	b2World_Draw(sys_physics_data.world_id, &sys_physics_data.debug_draw);
+	itu_lib_render_debug_end(context->renderer);
+}
+
+// exposed so that the game can toggle what gets drawn (joints, contacts, bounds, ...)
+b2DebugDraw* itu_sys_physics_get_debug_draw()
+{
+	return &sys_physics_data.debug_draw;
 }
 
 // for rendering capsules specifically we need a few more vertices
 #define MAX_POLYGON_VERTICES (B2_MAX_POLYGON_VERTICES + 2)
 
-void fn_box2d_wrapper_draw_polygon(b2Transform transform, const b2Vec2* vertices, int vertexCount, float radius, b2HexColor color, void* context)
+static color itu_sys_physics_debug_color(b2HexColor b2_color, float alpha)
 {
-	SDLContext* sdl_context = (SDLContext*)context;
-
-	float r = (float)((color & 0xFF0000) >> 16) / 255.0f;
-	float g = (float)((color & 0x00FF00) >>  8) / 255.0f;
-	float b = (float)((color & 0x0000FF))       / 255.0f;
-	SDL_FColor color_fill = {r, g, b, 0.25f};
+	color ret;
+	ret.r = (float)((b2_color & 0xFF0000) >> 16) / 255.0f;
+	ret.g = (float)((b2_color & 0x00FF00) >>  8) / 255.0f;
+	ret.b = (float)((b2_color & 0x0000FF))       / 255.0f;
+	ret.a = alpha;
+	return ret;
+}
 
-	SDL_FPoint vs_outline[MAX_POLYGON_VERTICES+1];
-	SDL_Vertex vs[MAX_POLYGON_VERTICES];
-	SDL_zeroa(vs);
-	
+// converts the (box2d world-space) points to screen space in one go
+static void itu_sys_physics_debug_points_to_screen(SDLContext* context, b2Transform transform, const b2Vec2* vertices, int vertexCount, vec2f* out_points)
+{
 	for (int i = 0; i < vertexCount; ++i)
 	{
 		b2Vec2 pos_b2world = b2TransformPoint(transform, vertices[i]);
-		vec2f pos = point_global_to_screen(sdl_context, value_cast(vec2f, pos_b2world));
-
-		vs[i].color = color_fill;
-		vs[i].position.x = pos.x;
-		vs[i].position.y = pos.y;
-		vs[i].tex_coord.x = 0;
-		vs[i].tex_coord.y = 0;
-		vs_outline[i].x = vs[i].position.x;
-		vs_outline[i].y = vs[i].position.y;
+		out_points[i] = value_cast(vec2f, pos_b2world);
 	}
-	vs_outline[vertexCount].x = vs_outline[0].x;
-	vs_outline[vertexCount].y = vs_outline[0].y;
+	points_global_to_screen(context, out_points, out_points, vertexCount);
+}
 
-	int indices_count = (vertexCount - 2)*3;
-	int indices[MAX_POLYGON_VERTICES*3];
-	int c = 0;
-	for (int i = 2; i < vertexCount; ++i)
-	{
-		indices[c++] = 0;
-		indices[c++] = i - 1;
-		indices[c++] = i;
-	}
+void fn_box2d_wrapper_draw_polygon(b2Transform transform, const b2Vec2* vertices, int vertexCount, float radius, b2HexColor color, void* context)
+{
+	SDLContext* sdl_context = (SDLContext*)context;
 
-	SDL_RenderGeometry(sdl_context->renderer, NULL, vs, vertexCount, indices, indices_count);
-	
-	SDL_SetRenderDrawColor(sdl_context->renderer, (color & 0xFF0000) >> 16, (color & 0x00FF00) >>  8, (color & 0x0000FF), 0xFF);
-	SDL_RenderLines(sdl_context->renderer, vs_outline, vertexCount+1);
+	vec2f points[MAX_POLYGON_VERTICES];
+	itu_sys_physics_debug_points_to_screen(sdl_context, transform, vertices, vertexCount, points);
+
+	itu_lib_render_draw_polygon(sdl_context->renderer, VEC2F_ZERO, points, vertexCount, itu_sys_physics_debug_color(color, 0.25f));
+}
+
+void fn_box2d_wrapper_draw_polygon_outline(const b2Vec2* vertices, int vertexCount, b2HexColor b2_color, void* context)
+{
+	SDLContext* sdl_context = (SDLContext*)context;
+
+	vec2f points[MAX_POLYGON_VERTICES];
+	itu_sys_physics_debug_points_to_screen(sdl_context, b2Transform_identity, vertices, vertexCount, points);
+
+	color c = itu_sys_physics_debug_color(b2_color, 1.0f);
+	for(int i = 0; i < vertexCount; ++i)
+		itu_lib_render_draw_line(sdl_context->renderer, points[i], points[(i + 1) % vertexCount], c);
 }
 
 void fn_box2d_wrapper_draw_circle(b2Transform transform, float radius, b2HexColor b2_color, void* context)
 {
-	float angle_increment = TAU / 8;
+	const vec2f* unit_circle = itu_lib_render_get_unit_circle(8);
 	b2Vec2 vertices[8];
 
 	for(int i = 0; i < 8; ++i)
 	{
-		float angle = angle_increment * i;
-		float px = radius * SDL_cos(angle);
-		float py = radius * SDL_sin(angle);
-
-		vertices[i].x = px;
-		vertices[i].y = py;
+		vertices[i].x = radius * unit_circle[i].x;
+		vertices[i].y = radius * unit_circle[i].y;
 	}
 
 	fn_box2d_wrapper_draw_polygon(transform, vertices, 8, radius, b2_color, context);
 }
 
+void fn_box2d_wrapper_draw_circle_outline(b2Vec2 center, float radius, b2HexColor b2_color, void* context)
+{
+	itu_lib_render_draw_world_circle((SDLContext*)context, value_cast(vec2f, center), radius, 16, itu_sys_physics_debug_color(b2_color, 1.0f));
+}
+
 void fn_box2d_wrapper_draw_capsule(b2Vec2 p1, b2Vec2 p2, float radius, b2HexColor b2_color, void* context)
 {
 	
 	// we are still segmenting the circle in 8 parts,
 	// but we need 2 extra vertices since we are de-facto "extruding" half the circle
 	int circle_splits = MAX_POLYGON_VERTICES - 2;
-	float angle_increment = TAU / circle_splits;
+	const vec2f* unit_circle = itu_lib_render_get_unit_circle(circle_splits);
 	b2Vec2 vertices[MAX_POLYGON_VERTICES];
 
 	b2Vec2 offset = p1;
@@ -197,21 +1522,52 @@ void fn_box2d_wrapper_draw_capsule(b2Vec2 p1, b2Vec2 p2, float radius, b2HexColo
 	{
 		for(int i = 0; i < circle_splits/2+1; ++i)
 		{
-			float angle = angle_increment * (i + (circle_splits/2) * circle_section);
-			float px = radius * SDL_cos(angle);
-			float py = radius * SDL_sin(angle);
+			vec2f p = unit_circle[(i + (circle_splits/2) * circle_section) % circle_splits];
 
-			vertices[c].x = px + offset.x;
-			vertices[c].y = py + offset.y;
+			vertices[c].x = radius * p.x + offset.x;
+			vertices[c].y = radius * p.y + offset.y;
 			++c;
 		}
 		offset = p2;
 	}
 	
 	// apparently capsule points come already transformed.
-	// No time (and hopefully no need) to make a more optimized version
 	fn_box2d_wrapper_draw_polygon(b2Transform_identity, vertices, MAX_POLYGON_VERTICES, radius, b2_color, context);
 }
 
+void fn_box2d_wrapper_draw_segment(b2Vec2 p1, b2Vec2 p2, b2HexColor b2_color, void* context)
+{
+	itu_lib_render_draw_world_line((SDLContext*)context, value_cast(vec2f, p1), value_cast(vec2f, p2), itu_sys_physics_debug_color(b2_color, 1.0f));
+}
+
+void fn_box2d_wrapper_draw_transform(b2Transform transform, void* context)
+{
+	const float axis_length = 0.5f;
+
+	b2Vec2 p = transform.p;
+	b2Vec2 axis_x = b2Add(p, b2MulSV(axis_length, b2Rot_GetXAxis(transform.q)));
+	b2Vec2 axis_y = b2Add(p, b2MulSV(axis_length, b2Rot_GetYAxis(transform.q)));
+
+	itu_lib_render_draw_world_line((SDLContext*)context, value_cast(vec2f, p), value_cast(vec2f, axis_x), COLOR_RED);
+	itu_lib_render_draw_world_line((SDLContext*)context, value_cast(vec2f, p), value_cast(vec2f, axis_y), COLOR_GREEN);
+}
+
+// NOTE: box2d point size is in pixels
+void fn_box2d_wrapper_draw_point(b2Vec2 p, float size, b2HexColor b2_color, void* context)
+{
+	itu_lib_render_draw_world_point((SDLContext*)context, value_cast(vec2f, p), size / 2, itu_sys_physics_debug_color(b2_color, 1.0f));
+}
+
+// NOTE: text is not batched, it is drawn immediately (so it ends up below batched shapes)
+void fn_box2d_wrapper_draw_string(b2Vec2 p, const char* s, b2HexColor b2_color, void* context)
+{
+	SDLContext* sdl_context = (SDLContext*)context;
+
+	vec2f pos = point_global_to_screen(sdl_context, value_cast(vec2f, p));
+	color c = itu_sys_physics_debug_color(b2_color, 1.0f);
+	SDL_SetRenderDrawColorFloat(sdl_context->renderer, c.r, c.g, c.b, c.a);
+	SDL_RenderDebugText(sdl_context->renderer, pos.x, pos.y, s);
+}
+
 
 #endif // (defined ITU_SYS_PHYSICS_IMPLEMENTATION) || (define ITU_UNITY_BUILD)
\ No newline at end of file
@@ -21,18 +21,25 @@
 
 #include <itu_common.hpp>
 #include <itu_lib_engine.hpp>
+#include <itu_lib_arena.hpp>
 
 #include <itu_lib_fileutils.hpp>
+#include <itu_lib_spritetable.hpp>
 
 #include <itu_entity_storage.hpp>
 #include <itu_resource_storage.hpp>
 
 #include <itu_lib_render.hpp>
+#include <itu_lib_render_queue.hpp>
 #include <itu_lib_overlaps.hpp>
 #include <itu_lib_sprite.hpp>
+#include <itu_lib_tilemap.hpp>
+#include <itu_lib_text.hpp>
 #include <itu_lib_imgui.hpp>
 // #include <itu_lib_box2d.hpp> // deprecated
 #include <itu_sys_physics.hpp>
+#include <itu_sys_collisions.hpp>
+#include <itu_lib_prefab.hpp>
 
 #include <itu_lib_debug_ui.hpp>
 
@@ -0,0 +1,82 @@
+// removing components from pools smaller than ENTITIES_COUNT_MAX (ie, `Contacts`) must go through the pool slots,
+// not the entity indices, and must keep the entity -> slot mapping of the element moved in the removed slot
+#define TEXTURE_PIXELS_PER_UNIT 128
+#define CAMERA_PIXELS_PER_UNIT  32
+
+#define PHYSICS_TIMESTEP_NSECS  (SECONDS(1) / 60)
+#define PHYSICS_TIMESTEP_SECS   NS_TO_SECONDS(PHYSICS_TIMESTEP_NSECS)
+#define PHYSICS_MAX_TIMESTEPS_PER_FRAME 4
+
+#define WINDOW_W 800
+#define WINDOW_H 600
+
+#include <itu_unity_include.hpp>
+
+// well past the size of the `Contacts` pool
+#define ENTITIES_COUNT (PHYSICS_CONTACTS_COMPONENTS_MAX + 100)
+
+static bool check_contacts(ITU_EntityId id, int expected)
+{
+	Contacts* contacts = entity_get_data(id, Contacts);
+	if(!contacts || contacts->count != expected)
+	{
+		SDL_Log("FAILED entity %d: expected contacts marker %d, got %d\n", id.index, expected, contacts ? contacts->count : -1);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	itu_sys_estorage_init(ENTITIES_COUNT);
+
+	ITU_EntityId* ids = (ITU_EntityId*)SDL_malloc(sizeof(ITU_EntityId) * ENTITIES_COUNT);
+	for(int i = 0; i < ENTITIES_COUNT; ++i)
+		ids[i] = itu_entity_create();
+
+	// a few entities with `Contacts`, each one marked with its own index
+	int with_contacts[] = { 5, PHYSICS_CONTACTS_COMPONENTS_MAX + 10, 42, ENTITIES_COUNT - 1 };
+	int with_contacts_count = SDL_arraysize(with_contacts);
+	for(int i = 0; i < with_contacts_count; ++i)
+	{
+		Contacts contacts;
+		SDL_zero(contacts);
+		contacts.count = with_contacts[i];
+		entity_add_component(ids[with_contacts[i]], Contacts, contacts);
+	}
+
+	bool ok = true;
+
+	// high index first (its slot is not its index), then a low one
+	itu_entity_destroy(ids[PHYSICS_CONTACTS_COMPONENTS_MAX + 10]);
+	ok &= check_contacts(ids[5], 5);
+	ok &= check_contacts(ids[42], 42);
+	ok &= check_contacts(ids[ENTITIES_COUNT - 1], ENTITIES_COUNT - 1);
+
+	itu_entity_destroy(ids[5]);
+	ok &= check_contacts(ids[42], 42);
+	ok &= check_contacts(ids[ENTITIES_COUNT - 1], ENTITIES_COUNT - 1);
+
+	// removed entities must not be mapped to any slot anymore (system queries rely on this)
+	ITU_Component* pool = ctx_estorage.components[component_type(Contacts)];
+	if(pool->count_alive != 2 || pool->data_loc[5] != (Uint64)-1 || pool->data_loc[PHYSICS_CONTACTS_COMPONENTS_MAX + 10] != (Uint64)-1)
+	{
+		SDL_Log("FAILED expected 2 entities with contacts, found %d\n", pool->count_alive);
+		ok = false;
+	}
+
+	// the freed slots can be used again
+	Contacts contacts;
+	SDL_zero(contacts);
+	contacts.count = 7;
+	entity_add_component(ids[7], Contacts, contacts);
+	ok &= check_contacts(ids[7], 7);
+	ok &= check_contacts(ids[ENTITIES_COUNT - 1], ENTITIES_COUNT - 1);
+
+	SDL_free(ids);
+
+	if(!ok)
+		return 1;
+	SDL_Log("OK\n");
+	return 0;
+}
@@ -0,0 +1,149 @@
+// physics snapshots: restoring right away must not change the simulation at all, and rewinding must stay within the
+// drift documented in `itu_sys_physics.hpp` (box2d contact caches can't be captured, so it can't be bit-identical)
+#define TEXTURE_PIXELS_PER_UNIT 128
+#define CAMERA_PIXELS_PER_UNIT  32
+
+#define PHYSICS_TIMESTEP_NSECS  (SECONDS(1) / 60)
+#define PHYSICS_TIMESTEP_SECS   NS_TO_SECONDS(PHYSICS_TIMESTEP_NSECS)
+#define PHYSICS_MAX_TIMESTEPS_PER_FRAME 4
+
+#define WINDOW_W 800
+#define WINDOW_H 600
+
+#include <itu_unity_include.hpp>
+
+#define BOXES_COUNT 200
+#define STEPS_BEFORE_SNAPSHOT 60
+#define STEPS_AFTER_SNAPSHOT  120
+
+#define DRIFT_MAX_WARM_STARTING    0.1f
+#define DRIFT_MAX_NO_WARM_STARTING 0.01f
+
+// a 20 boxes wide stack falling on the ground
+static void scene_build(b2BodyId* out_bodies, bool warm_starting)
+{
+	b2WorldDef world_def = b2DefaultWorldDef();
+	itu_sys_physics_reset(&world_def);
+	b2World_EnableWarmStarting(sys_physics_data.world_id, warm_starting);
+
+	b2BodyDef body_def = b2DefaultBodyDef();
+	b2ShapeDef shape_def = b2DefaultShapeDef();
+
+	ITU_PhysicsShape shape_ground;
+	shape_ground.type = b2_polygonShape;
+	shape_ground.polygon = b2MakeBox(50, 1);
+	ITU_EntityId id_ground = { 0, 0 };
+	itu_sys_physics_add_shape(itu_sys_physics_add_body(id_ground, &body_def), &shape_def, &shape_ground);
+
+	ITU_PhysicsShape shape_box;
+	shape_box.type = b2_polygonShape;
+	shape_box.polygon = b2MakeBox(0.5f, 0.5f);
+	body_def.type = b2_dynamicBody;
+	for(int i = 0; i < BOXES_COUNT; ++i)
+	{
+		int row = i / 20;
+		body_def.position = b2Vec2{ (float)(i % 20) - 10 + 0.05f * row, 2.0f + row * 1.1f };
+		ITU_EntityId id = { 0, (Uint32)i + 1 };
+		out_bodies[i] = itu_sys_physics_add_body(id, &body_def);
+		itu_sys_physics_add_shape(out_bodies[i], &shape_def, &shape_box);
+	}
+}
+
+static void scene_step(int steps_count)
+{
+	for(int i = 0; i < steps_count; ++i)
+		itu_sys_physics_step(1.0f / 60);
+}
+
+static float scene_max_distance(b2BodyId* bodies, b2Vec2* positions)
+{
+	float ret = 0;
+	for(int i = 0; i < BOXES_COUNT; ++i)
+		ret = SDL_max(ret, b2Distance(b2Body_GetPosition(bodies[i]), positions[i]));
+	return ret;
+}
+
+static bool test_restore_immediate(ITU_Arena* arena, bool warm_starting)
+{
+	b2BodyId bodies[BOXES_COUNT];
+	b2Vec2 positions[BOXES_COUNT];
+
+	// reference run
+	scene_build(bodies, warm_starting);
+	scene_step(STEPS_BEFORE_SNAPSHOT + STEPS_AFTER_SNAPSHOT);
+	for(int i = 0; i < BOXES_COUNT; ++i)
+		positions[i] = b2Body_GetPosition(bodies[i]);
+
+	// same run, with a snapshot restored right after being saved
+	scene_build(bodies, warm_starting);
+	scene_step(STEPS_BEFORE_SNAPSHOT);
+	PhysicsSnapshot* snapshot = itu_sys_physics_snapshot_save(arena);
+	itu_sys_physics_snapshot_restore(snapshot);
+	scene_step(STEPS_AFTER_SNAPSHOT);
+
+	float distance = scene_max_distance(bodies, positions);
+	if(distance != 0)
+	{
+		SDL_Log("FAILED immediate restore (warm starting %d): drift %f, expected none\n", warm_starting, distance);
+		return false;
+	}
+	return true;
+}
+
+static bool test_restore_rewind(ITU_Arena* arena, bool warm_starting)
+{
+	b2BodyId bodies[BOXES_COUNT];
+	b2Vec2 positions[BOXES_COUNT];
+
+	scene_build(bodies, warm_starting);
+	scene_step(STEPS_BEFORE_SNAPSHOT);
+	PhysicsSnapshot* snapshot = itu_sys_physics_snapshot_save(arena);
+	if(snapshot->bodies_count != BOXES_COUNT + 1)
+	{
+		SDL_Log("FAILED snapshot has %d bodies, expected %d\n", snapshot->bodies_count, BOXES_COUNT + 1);
+		return false;
+	}
+
+	scene_step(STEPS_AFTER_SNAPSHOT);
+	for(int i = 0; i < BOXES_COUNT; ++i)
+		positions[i] = b2Body_GetPosition(bodies[i]);
+
+	itu_sys_physics_snapshot_restore(snapshot);
+	scene_step(STEPS_AFTER_SNAPSHOT);
+
+	float distance = scene_max_distance(bodies, positions);
+	float distance_max = warm_starting ? DRIFT_MAX_WARM_STARTING : DRIFT_MAX_NO_WARM_STARTING;
+	SDL_Log("rewind (warm starting %d): drift %f (max %f)\n", warm_starting, distance, distance_max);
+	if(distance > distance_max)
+	{
+		SDL_Log("FAILED rewind (warm starting %d): drift over the documented tolerance\n", warm_starting);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	SDLContext context;
+	SDL_zero(context);
+	itu_sys_physics_init(&context);
+
+	// NOTE: box2d is deterministic with any worker count, but this keeps the test independent from the machine
+	itu_sys_physics_set_workers_count(1);
+
+	ITU_Arena arena;
+	itu_lib_arena_init(&arena, MB(1));
+
+	bool ok = true;
+	ok &= test_restore_immediate(&arena, true);
+	ok &= test_restore_immediate(&arena, false);
+	ok &= test_restore_rewind(&arena, true);
+	ok &= test_restore_rewind(&arena, false);
+
+	itu_lib_arena_free(&arena);
+
+	if(!ok)
+		return 1;
+	SDL_Log("OK\n");
+	return 0;
+}